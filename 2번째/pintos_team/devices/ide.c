@@ -8,6 +8,7 @@
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
+#include "threads/softirq.h"
 #include "threads/synch.h"
 
 /* The code in this file is an interface to an ATA (IDE)
@@ -70,7 +71,8 @@ struct channel
     struct lock lock;           /* Must acquire to access the controller. */
     bool expecting_interrupt;   /* True if an interrupt is expected, false if
                                    any interrupt would be spurious. */
-    struct semaphore completion_wait;   /* Up'd by interrupt handler. */
+    struct semaphore completion_wait;   /* Up'd by completion_work. */
+    struct softirq_work completion_work; /* Raised by interrupt handler. */
 
     struct ata_disk devices[2];     /* The devices on this channel. */
   };
@@ -96,6 +98,7 @@ static void select_device (const struct ata_disk *);
 static void select_device_wait (const struct ata_disk *);
 
 static void interrupt_handler (struct intr_frame *);
+static softirq_func complete_command;
 
 /* Initialize the disk subsystem and detect disks. */
 void
@@ -123,9 +126,11 @@ ide_init (void)
         default:
           NOT_REACHED ();
         }
-      lock_init (&c->lock);
+      lock_init_named (&c->lock, c->name);
       c->expecting_interrupt = false;
       sema_init (&c->completion_wait, 0);
+      softirq_work_init (&c->completion_work, complete_command,
+                         &c->completion_wait);
  
       /* Initialize devices. */
       for (dev_no = 0; dev_no < 2; dev_no++)
@@ -514,7 +519,7 @@ interrupt_handler (struct intr_frame *f)
         if (c->expecting_interrupt) 
           {
             inb (reg_status (c));               /* Acknowledge interrupt. */
-            sema_up (&c->completion_wait);      /* Wake up waiter. */
+            softirq_raise (&c->completion_work, SOFTIRQ_BLOCK);
           }
         else
           printf ("%s: unexpected interrupt\n", c->name);
@@ -524,4 +529,12 @@ interrupt_handler (struct intr_frame *f)
   NOT_REACHED ();
 }
 
+/* Deferred part of the interrupt handler: wakes up the thread
+   waiting for the command to complete, given its semaphore. */
+static void
+complete_command (void *completion_wait)
+{
+  sema_up (completion_wait);
+}
+
 
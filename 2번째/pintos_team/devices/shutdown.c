@@ -4,7 +4,9 @@
 #include "devices/kbd.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
+#include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/schedtrace.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
@@ -130,6 +132,7 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  intr_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
@@ -138,4 +141,5 @@ print_stats (void)
 #ifdef USERPROG
   exception_print_stats ();
 #endif
+  schedtrace_dump ();
 }
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include "devices/pit.h"
 #include "threads/interrupt.h"
+#include "threads/softirq.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
   
@@ -20,11 +21,36 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* Dynamic-tick mode, selected with -nohz.  When the idle thread
+   is the only runnable thread, it stops the periodic tick and
+   programs a one-shot interrupt for the next sleep deadline
+   instead, then catches `ticks' up when it wakes. */
+bool timer_tickless;
+
+/* PIT cycles per timer tick, and the most ticks a single 16-bit
+   one-shot count can cover. */
+#define CYCLES_PER_TICK ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+#define ONESHOT_MAX_TICKS (65535 / CYCLES_PER_TICK)
+
+/* Ticks covered by the pending one-shot interrupt, or 0 if the
+   timer is running periodically. */
+static int64_t oneshot_ticks;
+
+/* Statistics. */
+static long long oneshot_cnt;   /* # of one-shot idle sleeps. */
+static long long skipped_ticks; /* # of ticks without an interrupt. */
+static long long early_wakes;   /* # of one-shots cut short. */
+
+/* Wakes up sleeping threads after the timer interrupt returns. */
+static struct softirq_work wakeup_work;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
 static intr_handler_func timer_interrupt;
+static softirq_func timer_wakeup;
+static void oneshot_finish (int64_t elapsed);
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -36,6 +62,7 @@ void
 timer_init (void) 
 {
   pit_configure_channel (0, 2, TIMER_FREQ);
+  softirq_work_init (&wakeup_work, timer_wakeup, NULL);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
@@ -166,18 +193,104 @@ void
 timer_print_stats (void) 
 {
   printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
+  if (timer_tickless)
+    printf ("Timer: %lld one-shot idle sleeps, %lld ticks skipped, "
+            "%lld early wakeups\n", oneshot_cnt, skipped_ticks, early_wakes);
+}
+
+/* Called by the idle thread, with interrupts off, when no other
+   thread is ready to run.  In dynamic-tick mode, if the next
+   sleep deadline is more than a tick away, stops the periodic
+   tick, programs a one-shot interrupt for that deadline (or as
+   far as the PIT can count), and halts until an interrupt
+   arrives.  Returns true if it halted, false if the caller should
+   wait for the next periodic tick itself. */
+bool
+timer_idle_oneshot (void)
+{
+  int64_t delta;
+  uint16_t remaining;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!timer_tickless)
+    return false;
+
+  delta = get_next_tick_to_wakeup () - ticks;
+  if (delta <= 1)
+    return false;
+  if (delta > ONESHOT_MAX_TICKS)
+    delta = ONESHOT_MAX_TICKS;
+
+  oneshot_ticks = delta;
+  oneshot_cnt++;
+  pit_configure_oneshot (0, delta * CYCLES_PER_TICK);
+
+  /* `sti' takes effect after `hlt' starts, so no interrupt can
+     slip in between; see idle() in threads/thread.c. */
+  asm volatile ("sti; hlt" : : : "memory");
+  intr_disable ();
+
+  /* Some other device woke us before the one-shot expired.
+     Account for the whole ticks that did pass and go back to
+     periodic mode.  If the count ran out in the meantime it has
+     wrapped past the programmed value, and the timer interrupt,
+     still pending, will stand for the last tick. */
+  if (oneshot_ticks > 0)
+    {
+      int64_t total = oneshot_ticks * CYCLES_PER_TICK;
+
+      remaining = pit_read_count (0);
+      early_wakes++;
+      if (remaining > total)
+        oneshot_finish (oneshot_ticks - 1);
+      else
+        oneshot_finish ((total - remaining) / CYCLES_PER_TICK);
+    }
+  return true;
+}
+
+/* Ends the pending one-shot period after ELAPSED whole ticks
+   passed without interrupts: restarts the periodic tick and
+   credits the missing ticks to the clock and to the idle
+   thread. */
+static void
+oneshot_finish (int64_t elapsed)
+{
+  oneshot_ticks = 0;
+  pit_configure_channel (0, 2, TIMER_FREQ);
+  if (elapsed > 0)
+    {
+      thread_tick_idle (ticks + 1, elapsed);
+      ticks += elapsed;
+      skipped_ticks += elapsed;
+    }
 }
 
 /* Timer interrupt handler. */
 static void
 timer_interrupt (struct intr_frame *args UNUSED)
 {
+  /* A one-shot interrupt stands for the ticks it covered; the
+     last of them is handled below like any other tick. */
+  if (oneshot_ticks > 0)
+    oneshot_finish (oneshot_ticks - 1);
+
   ticks++;
   thread_tick ();
 
-  if (get_next_tick_to_wakeup() <= ticks) {
-    thread_wakeup(ticks);
-  }
+  if (get_next_tick_to_wakeup() <= ticks)
+    softirq_raise (&wakeup_work, SOFTIRQ_TIMER);
+}
+
+/* Deferred part of the timer interrupt: wakes up every thread
+   whose sleep has ended by now. */
+static void
+timer_wakeup (void *aux UNUSED)
+{
+  enum intr_level old_level = intr_disable ();
+  thread_wakeup (ticks);
+  intr_set_level (old_level);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -2,13 +2,18 @@
 #define DEVICES_TIMER_H
 
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* -nohz: stop the periodic tick while idle. */
+extern bool timer_tickless;
+
 void timer_init (void);
 void timer_calibrate (void);
+bool timer_idle_oneshot (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
@@ -7,6 +7,9 @@
 
 static struct file *free_map_file;   /* Free map file. */
 static struct bitmap *free_map;      /* Free map, one bit per sector. */
+static block_sector_t next_sector;   /* Where allocation looks first. */
+
+static size_t find_sectors (size_t cnt);
 
 /* Initializes the free map. */
 void
@@ -27,7 +30,9 @@ free_map_init (void)
 bool
 free_map_allocate (size_t cnt, block_sector_t *sectorp)
 {
-  block_sector_t sector = bitmap_scan_and_flip (free_map, 0, cnt, false);
+  block_sector_t sector = find_sectors (cnt);
+  if (sector != BITMAP_ERROR)
+    bitmap_set_multiple (free_map, sector, cnt, true);
   if (sector != BITMAP_ERROR
       && free_map_file != NULL
       && !bitmap_write (free_map, free_map_file))
@@ -36,10 +41,35 @@ free_map_allocate (size_t cnt, block_sector_t *sectorp)
       sector = BITMAP_ERROR;
     }
   if (sector != BITMAP_ERROR)
-    *sectorp = sector;
+    {
+      *sectorp = sector;
+      next_sector = sector + cnt;
+    }
   return sector != BITMAP_ERROR;
 }
 
+/* Returns the first of CNT consecutive free sectors to allocate,
+   or BITMAP_ERROR if there are none.
+
+   The free map picks sectors for the disk, not for the page
+   allocator, so it does not follow -ma.  It looks first at or
+   after the end of the previous allocation, so that files
+   created one after another lie next to each other and can be
+   read in one sweep of the disk head.  Failing that, it takes
+   the shortest free run anywhere that is long enough, to keep
+   the long runs whole for large files. */
+static size_t
+find_sectors (size_t cnt)
+{
+  size_t sector = BITMAP_ERROR;
+
+  if (next_sector < bitmap_size (free_map))
+    sector = bitmap_scan (free_map, next_sector, cnt, false);
+  if (sector == BITMAP_ERROR)
+    sector = bitmap_scan_best (free_map, 0, cnt, false);
+  return sector;
+}
+
 /* Makes CNT sectors starting at SECTOR available for use. */
 void
 free_map_release (block_sector_t sector, size_t cnt)
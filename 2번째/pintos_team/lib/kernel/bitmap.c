@@ -4,7 +4,6 @@
 #include <round.h>
 #include <stdio.h>
 #include "threads/malloc.h"
-#include "threads/palloc.h"
 #ifdef FILESYS
 #include "filesys/file.h"
 #endif
@@ -70,6 +69,76 @@ last_mask (const struct bitmap *b)
   return last_bits ? ((elem_type) 1 << last_bits) - 1 : (elem_type) -1;
 }
 
+/* Returns a mask of the CNT bits starting at bit OFS of an
+   element.  OFS + CNT must not exceed ELEM_BITS. */
+static inline elem_type
+span_mask (size_t ofs, size_t cnt)
+{
+  if (cnt == ELEM_BITS)
+    return (elem_type) -1;
+  return (((elem_type) 1 << cnt) - 1) << ofs;
+}
+
+/* Returns how many of the bits from START up to END, exclusive,
+   are in the element that holds bit START. */
+static inline size_t
+span_len (size_t start, size_t end)
+{
+  size_t left = ELEM_BITS - start % ELEM_BITS;
+  return end - start < left ? end - start : left;
+}
+
+/* Returns the number of the lowest set bit in W, which must not
+   be 0.  See [IA32-v2a] "BSF". */
+static inline size_t
+first_set (elem_type w)
+{
+  elem_type idx;
+  asm ("bsfl %1, %0" : "=r" (idx) : "rm" (w) : "cc");
+  return idx;
+}
+
+/* Returns the number of set bits in W, adding up bits in pairs,
+   then nibbles, then bytes, and then summing the bytes with one
+   multiply. */
+static inline size_t
+popcount (elem_type w)
+{
+  const elem_type ones = (elem_type) -1;
+
+  w -= (w >> 1) & (ones / 3);
+  w = (w & (ones / 15 * 3)) + ((w >> 2) & (ones / 15 * 3));
+  w = (w + (w >> 4)) & (ones / 255 * 15);
+  return (elem_type) (w * (ones / 255)) >> (sizeof w - 1) * CHAR_BIT;
+}
+
+/* Returns the index of the first bit in B at or after START, and
+   before END, that is set to VALUE, or END if there is none.
+   Looks at a whole element at a time. */
+static size_t
+find_next (const struct bitmap *b, size_t start, size_t end, bool value)
+{
+  const elem_type flip = value ? 0 : (elem_type) -1;
+  size_t idx = elem_idx (start);
+  elem_type w;
+
+  if (start >= end)
+    return end;
+
+  /* Turn the bits equal to VALUE on, and ignore those before
+     START.  Bits past the end of B may turn on too; END cuts
+     them off. */
+  w = (b->bits[idx] ^ flip) & ((elem_type) -1 << (start % ELEM_BITS));
+  while (w == 0)
+    {
+      if (++idx * ELEM_BITS >= end)
+        return end;
+      w = b->bits[idx] ^ flip;
+    }
+  start = idx * ELEM_BITS + first_set (w);
+  return start < end ? start : end;
+}
+
 /* Creation and destruction. */
 
 /* Creates and returns a pointer to a newly allocated bitmap with room for
@@ -217,18 +286,31 @@ bitmap_set_all (struct bitmap *b, bool value)
   bitmap_set_multiple (b, 0, bitmap_size (b), value);
 }
 
-/* Sets the CNT bits starting at START in B to VALUE. */
+/* Sets the CNT bits starting at START in B to VALUE.  Each
+   element is updated atomically, a whole element at a time. */
 void
 bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
-  size_t i;
+  size_t end = start + cnt;
   
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    bitmap_set (b, start + i, value);
+  while (start < end)
+    {
+      size_t ofs = start % ELEM_BITS;
+      size_t n = span_len (start, end);
+      elem_type *e = &b->bits[elem_idx (start)];
+      elem_type mask = span_mask (ofs, n);
+
+      /* See bitmap_mark() and bitmap_reset(). */
+      if (value)
+        asm ("orl %1, %0" : "=m" (*e) : "r" (mask) : "cc");
+      else
+        asm ("andl %1, %0" : "=m" (*e) : "r" (~mask) : "cc");
+      start += n;
+    }
 }
 
 /* Returns the number of bits in B between START and START + CNT,
@@ -236,17 +318,22 @@ bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
 size_t
 bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
-  size_t i, value_cnt;
+  size_t end = start + cnt;
+  size_t set_cnt = 0;
 
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  value_cnt = 0;
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test (b, start + i) == value)
-      value_cnt++;
-  return value_cnt;
+  while (start < end)
+    {
+      size_t ofs = start % ELEM_BITS;
+      size_t n = span_len (start, end);
+
+      set_cnt += popcount (b->bits[elem_idx (start)] & span_mask (ofs, n));
+      start += n;
+    }
+  return value ? set_cnt : cnt - set_cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
@@ -254,16 +341,11 @@ bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
 bool
 bitmap_contains (const struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
-  size_t i;
-  
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test (b, start + i) == value)
-      return true;
-  return false;
+  return find_next (b, start, start + cnt, value) < start + cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
@@ -290,152 +372,91 @@ bitmap_all (const struct bitmap *b, size_t start, size_t cnt)
   return !bitmap_contains (b, start, cnt, false);
 }
 
-void tree_print(size_t * tree){       // 사용 중인 영역을 확인하기 위하여 선언한 테스트 코드.
-  printf("tree-------------------------\n");
-  for(int i = 0 ;i<16 ; i++){
-    for(int j =0 ; j<32; j++){
-      printf("%d",tree[(i*32) + j]);
-    }
-    printf("\n");
-  }
-}
-bool
-buddy_remove (size_t start, size_t cnt) // free를 할때 cnt와 할당 받았던 index가 넘어온다.
+/* Finding set or unset bits. */
+
+/* Finds and returns the starting index of the first group of CNT
+   consecutive bits in B at or after START that are all set to
+   VALUE, or BITMAP_ERROR if there is no such group.  Steps from
+   one run of VALUE bits to the next, a whole element at a time. */
+static size_t
+first_fit (const struct bitmap *b, size_t start, size_t cnt, bool value)
 {
-  size_t binary_size = 1;             // 할당을 2의 제곱수 만큼 했기 때문에 마찬가지로 cnt보다 큰 2의 제곱수를 구한다.
-    while(1){
-      binary_size*=2;
-      if(cnt <= binary_size)
-      break;
-    }
+  while (start < b->bit_cnt)
+    {
+      size_t run = find_next (b, start, b->bit_cnt, value);
+      size_t run_end = find_next (b, run, b->bit_cnt, !value);
 
-    if(cnt == 1){
-      binary_size = 1;
+      if (run_end - run >= cnt)
+        return run;
+      start = run_end;
     }
+  return BITMAP_ERROR;
+}
 
-  for(int j = start; j< start + binary_size; j++){  // 다시 그 영역을 사용할 수 있으므로 색칠한 영역을 다시 초기화한다.
-      tree[j] = 0;
-  }
+/* Finds and returns the starting index of the shortest group of
+   at least CNT consecutive bits in B at or after START that are
+   all set to VALUE, the first such if there are several, or
+   BITMAP_ERROR if there is none. */
+static size_t
+best_fit (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t best = BITMAP_ERROR, best_len = SIZE_MAX;
+
+  while (start < b->bit_cnt)
+    {
+      size_t run = find_next (b, start, b->bit_cnt, value);
+      size_t run_end = find_next (b, run, b->bit_cnt, !value);
 
+      if (run_end - run >= cnt && run_end - run < best_len)
+        {
+          best = run;
+          best_len = run_end - run;
+          if (best_len == cnt)
+            break;
+        }
+      start = run_end;
+    }
+  return best;
 }
-
-/* Finding set or unset bits. */
 
 /* Finds and returns the starting index of the first group of CNT
    consecutive bits in B at or after START that are all set to
-   VALUE.
-   If there is no such group, returns BITMAP_ERROR. */
+   VALUE.  If there is no such group, returns BITMAP_ERROR.  If
+   CNT is zero, returns START. */
 size_t
 bitmap_scan (const struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
-  
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
-  
-  static size_t recent = 0;     //가장 최근에 할당된 위치 (next fit 알고리즘을 위한 변수)
-  static size_t check_cnt = 0;    //해당 함수가 실행되는 횟수
-  static size_t check_size = 0;   //할당되는 공간의 크기 
-
-  if(check_cnt < 3)
-  {
-    check_size = check_size + cnt;
-  }
-  if (cnt <= b->bit_cnt) 
-    {
-      size_t last = b->bit_cnt - cnt;
-      size_t i;
-    
-    if(pallocator == 0)   //first fit 메모리 할당 알고리즘 호출
-    {
-      for (i = start; i <= last; i++){
-        if (!bitmap_contains (b, i, cnt, !value))
-          return i; 
-    }
-    }
-    else if(pallocator == 1)    //next fit 메모리 할당 알고리즘 호출(-ma=1 입력시 nextfit 실행)
-    {
-      for(i = recent; i <= last; i++) { //가장 최근에 배치된 메모리 위치에서부터 마지막 위치까지 검색
-        if (!bitmap_contains (b, i, cnt, !value))
-        {
-          recent = i;
-          return i;
-        }
-      }
-        for (i = start; i<= recent; i++)  { //메모리의 시작점인 위치부터 가장 최근에 배치된 메모리 위치까지 검색. 
-                          //맨 마지막까지 할당받으면 nextfit은 직전에 할당했던곳 부터 할당하는데 마지막까지 할당하는 부분이 최근으로 참조했던 부분이니깐 다시 처음부터 다시 끝까지 탐색.
-          if (!bitmap_contains (b, i, cnt, !value))
-            
-            {
-              recent = i;
-              return i;
-            }   
-        }
-    }
-    else if(pallocator == 2)      //best fit 메모리 할당 알고리즘 호출(-ma=2 입력시 bestfit 실행)
-    {
-      size_t idx = 0;       //fit될 수 있는 인덱스
-      size_t tempIdx = 0;     //그 다음의 인덱스
-      bool space = 0;       //이 변수에 할당가능한 인덱스들이 저장.
-      size_t size = b->bit_cnt;   //공간 최대크기
 
-      for(i= start; i <= last; i++){        //메모리 시작점 처음부터 끝까지 검색
-        if(bitmap_test (b, start + i) == false) //만약 i bit가 0이면
-        {
-          if(space == 0)    //할당받을수 있는 첫번째 영역에 인덱스를 만남
-          {
-            tempIdx = i;
-            if(idx == 0) idx = tempIdx;   // 뒷 부분에 할당된 공간이 없을 수도 있기 때문에 미리 인덱스를 저장.
-          }
-          space ++;       //공간에 할당가능한 그 다음의 인덱스가 증가
-        }
-        else  //만약 i bit가 1이면
-        {
-          if((space >= cnt)&&(space < size))
-          {
-            size = space;
-            idx = tempIdx;        //인덱스는 현 인덱스로 저장
-          }
-          space = 0;      //1을 만나면 space를 0으로 초기화
-        }
-      }
-      return idx;   //인덱스 반환
-    }
-      
-  
-    
-  else if(pallocator == 3){
-      size_t binary_size = 1;     // cnt보다 큰 2의 제곱수를 구하기 위하여 선언
-      while(1){
-        binary_size*=2;           // 2씩 곱하면서 2의 제곱으로 만든다.
-        if(cnt <= binary_size)    // 2의 제곱수를 구하면 break;
-        break;
-      }
-
-      if(cnt == 1){               // 시스템에서 필요로하는 cnt가 1개씩 3개를 받기때문에 2의 제곱수를 무시한다.
-        binary_size = 1;
-      }
-    
-    
-      for (i = start; i <= last; i++){        // 처음부터 마지막 까지 검사를 한다.
-          if (!bitmap_contains (b, i, binary_size, !value) && i%binary_size == 0 && tree[i] != 1){
-            printf("idx : %d cnt : %d binary_size : %d\n", i , cnt, binary_size);
-            // 2의 제곱수 만큼 할당 받을 수 있는 시작 index를 구할때, i가 구해진 2의 제곱수로 나눴을때 0이고 사용중인 영역(tree)가 1이 아니여야 그 영역을 사용가능하므로
-            // 조건을 걸었다. buddy 시스템을 할때 0부터 구한 binary_size만큼 건너뛰면서 검사한다고 생각하면 된다.
-            for(int j = i; j< i + binary_size; j++){    // 찾은 영역을 색칠한다.
-              tree[j] = 1;
-            }
-            tree_print(tree);
-            return i; 
-          }
-      }
-  
-   }
+  if (cnt == 0)
+    return start;
+  if (cnt > b->bit_cnt)
+    return BITMAP_ERROR;
+  return first_fit (b, start, cnt, value);
 }
+
+/* Finds and returns the starting index of the shortest group of
+   at least CNT consecutive bits in B at or after START that are
+   all set to VALUE, the first such if there are several.  If
+   there is no such group, returns BITMAP_ERROR.  If CNT is zero,
+   returns START. */
+size_t
+bitmap_scan_best (const struct bitmap *b, size_t start, size_t cnt,
+                  bool value)
+{
+  ASSERT (b != NULL);
+  ASSERT (start <= b->bit_cnt);
+
+  if (cnt == 0)
+    return start;
+  if (cnt > b->bit_cnt)
+    return BITMAP_ERROR;
+  return best_fit (b, start, cnt, value);
 }
 
 
-/* Finds the first gro
-up of CNT consecutive bits in B at or after
+/* Finds the first group of CNT consecutive bits in B at or after
    START that are all set to VALUE, flips them all to !VALUE,
    and returns the index of the first bit in the group.
    If there is no such group, returns BITMAP_ERROR.
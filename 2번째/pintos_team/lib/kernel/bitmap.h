@@ -6,7 +6,6 @@
 #include <inttypes.h>
 
 /* Bitmap abstract data type. */
-static size_t tree[512];			// buddy 시스템에서 2의 제곱수로 사용중인 영역을 색칠하기 위하여 선언.
 
 /* Creation and destruction. */
 struct bitmap *bitmap_create (size_t bit_cnt);
@@ -36,6 +35,8 @@ bool bitmap_all (const struct bitmap *, size_t start, size_t cnt);
 /* Finding set or unset bits. */
 #define BITMAP_ERROR SIZE_MAX
 size_t bitmap_scan (const struct bitmap *, size_t start, size_t cnt, bool);
+size_t bitmap_scan_best (const struct bitmap *, size_t start, size_t cnt,
+                         bool);
 size_t bitmap_scan_and_flip (struct bitmap *, size_t start, size_t cnt, bool);
 
 /* File input and output. */
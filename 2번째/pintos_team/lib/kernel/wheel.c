@@ -0,0 +1,288 @@
+#include "wheel.h"
+#include "../debug.h"
+
+#define SLOT_MASK (WHEEL_SLOTS - 1)
+
+/* Returns the number of ticks covered by one slot of LEVEL. */
+static inline int64_t
+slot_ticks (int level)
+{
+  return (int64_t) 1 << (level * WHEEL_BITS);
+}
+
+/* Returns the slot of LEVEL that tick T falls into. */
+static inline int
+slot_of (int level, int64_t t)
+{
+  return (t >> (level * WHEEL_BITS)) & SLOT_MASK;
+}
+
+/* Marks SLOT of LEVEL in W as non-empty. */
+static inline void
+map_set (struct wheel *w, int level, int slot)
+{
+  w->map[level][slot / 32] |= (uint32_t) 1 << (slot % 32);
+}
+
+/* Marks SLOT of LEVEL in W as empty. */
+static inline void
+map_clear (struct wheel *w, int level, int slot)
+{
+  w->map[level][slot / 32] &= ~((uint32_t) 1 << (slot % 32));
+}
+
+/* Returns the first non-empty slot of LEVEL in W at or after
+   slot FROM, wrapping around, or -1 if LEVEL is empty. */
+static int
+map_find_from (const struct wheel *w, int level, int from)
+{
+  const uint32_t *map = w->map[level];
+  int i;
+
+  for (i = 0; i <= WHEEL_SLOTS / 32; i++)
+    {
+      int word = (from / 32 + i) % (WHEEL_SLOTS / 32);
+      uint32_t bits = map[word];
+
+      /* In the first word skip the slots before FROM; when we
+         wrap back to it, look only at those. */
+      if (i == 0)
+        bits &= (uint32_t) -1 << (from % 32);
+      else if (i == WHEEL_SLOTS / 32)
+        bits &= ((uint32_t) 1 << (from % 32)) - 1;
+
+      if (bits != 0)
+        return word * 32 + __builtin_ctz (bits);
+    }
+  return -1;
+}
+
+/* Returns the first non-empty slot of LEVEL in W in the order
+   the slots will be reached, or -1 if LEVEL is empty.  Above
+   level 0, the slot the base is in has been cascaded already
+   unless the base sits right on its first tick, so anything in
+   it waits for the next revolution and it comes last. */
+static int
+first_slot (const struct wheel *w, int level)
+{
+  int cur = slot_of (level, w->base);
+
+  if (level > 0 && (w->base & (slot_ticks (level) - 1)) != 0)
+    cur = (cur + 1) & SLOT_MASK;
+  return map_find_from (w, level, cur);
+}
+
+/* Returns the first tick at or after W's base at which
+   wheel_advance() has work to do: the tick of the first
+   non-empty slot of level 0, or the tick at which the first
+   non-empty slot of a higher level is cascaded, whichever comes
+   first.  Returns INT64_MAX if W is empty. */
+static int64_t
+next_event (const struct wheel *w)
+{
+  int64_t next = INT64_MAX;
+  int level;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+      int shift = level * WHEEL_BITS;
+      int cur = slot_of (level, w->base);
+      int slot = first_slot (w, level);
+      int64_t start;
+
+      if (slot < 0)
+        continue;
+
+      /* SLOT is reached (SLOT - CUR) slots of this level from now,
+         or a whole revolution later if it is CUR and has been
+         cascaded already. */
+      start = ((w->base >> shift) + ((slot - cur) & SLOT_MASK)) << shift;
+      if (start < w->base)
+        start += slot_ticks (level + 1);
+      if (start < next)
+        next = start;
+    }
+  return next;
+}
+
+/* Files E, whose expiry is already set, into the right slot of W
+   relative to W's base. */
+static void
+place (struct wheel *w, struct wheel_elem *e)
+{
+  int64_t expires = e->expires < w->base ? w->base : e->expires;
+  int64_t delta = expires - w->base;
+  int level, slot;
+
+  for (level = 0; level < WHEEL_LEVELS - 1; level++)
+    if (delta < slot_ticks (level + 1))
+      break;
+
+  /* Expiries beyond the top level's range are parked in its last
+     reachable slot and refiled when that slot is cascaded. */
+  if (delta >= slot_ticks (WHEEL_LEVELS))
+    expires = w->base + slot_ticks (WHEEL_LEVELS) - 1;
+
+  slot = slot_of (level, expires);
+  e->slot = level * WHEEL_SLOTS + slot;
+  list_push_back (&w->slots[level][slot], &e->list_elem);
+  map_set (w, level, slot);
+}
+
+/* Empties SLOT of LEVEL in W, refiling each of its elements
+   relative to W's current base.  Returns SLOT. */
+static int
+cascade (struct wheel *w, int level, int slot)
+{
+  struct list *list = &w->slots[level][slot];
+  struct list pending;
+
+  /* Detach the slot first: refiled elements may land right back
+     in it if they are a full revolution away. */
+  list_init (&pending);
+  while (!list_empty (list))
+    list_push_back (&pending, list_pop_front (list));
+  map_clear (w, level, slot);
+
+  while (!list_empty (&pending))
+    place (w, list_entry (list_pop_front (&pending),
+                          struct wheel_elem, list_elem));
+  return slot;
+}
+
+/* Initializes W as an empty wheel whose next tick to process is
+   NOW. */
+void
+wheel_init (struct wheel *w, int64_t now)
+{
+  int level, slot;
+
+  ASSERT (w != NULL);
+
+  w->base = now;
+  w->elem_cnt = 0;
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+      for (slot = 0; slot < WHEEL_SLOTS / 32; slot++)
+        w->map[level][slot] = 0;
+      for (slot = 0; slot < WHEEL_SLOTS; slot++)
+        list_init (&w->slots[level][slot]);
+    }
+}
+
+/* Inserts E into W to expire at tick EXPIRES.  If EXPIRES has
+   already passed, E expires on the next wheel_advance(). */
+void
+wheel_insert (struct wheel *w, struct wheel_elem *e, int64_t expires)
+{
+  ASSERT (w != NULL);
+  ASSERT (e != NULL);
+
+  e->expires = expires;
+  place (w, e);
+  w->elem_cnt++;
+}
+
+/* Removes E, which must be in W, without expiring it. */
+void
+wheel_remove (struct wheel *w, struct wheel_elem *e)
+{
+  int level = e->slot / WHEEL_SLOTS;
+  int slot = e->slot % WHEEL_SLOTS;
+
+  ASSERT (w != NULL);
+  ASSERT (w->elem_cnt > 0);
+
+  list_remove (&e->list_elem);
+  if (list_empty (&w->slots[level][slot]))
+    map_clear (w, level, slot);
+  w->elem_cnt--;
+}
+
+/* Processes every tick of W up to and including NOW, calling
+   ACTION with AUX on each element as it expires.  An element is
+   removed from W before ACTION is called, so ACTION may reinsert
+   it.  Ticks with nothing to expire or cascade are skipped
+   without being visited, so the cost depends on the number of
+   occupied slots passed, not on the number of ticks. */
+void
+wheel_advance (struct wheel *w, int64_t now,
+               wheel_action_func *action, void *aux)
+{
+  ASSERT (w != NULL);
+
+  while (w->base <= now)
+    {
+      int64_t next = next_event (w);
+      int slot;
+      struct list *list;
+      struct list expired;
+      int level;
+
+      /* Jump to the next tick that has work, or past NOW. */
+      if (next > now)
+        {
+          w->base = now + 1;
+          break;
+        }
+      w->base = next;
+      slot = slot_of (0, w->base);
+      list = &w->slots[0][slot];
+
+      /* On a level 0 wrap, pull the next slot of each higher
+         level down, stopping at the first level that did not
+         wrap itself. */
+      for (level = 1; level < WHEEL_LEVELS
+                      && slot_of (level - 1, w->base) == 0; level++)
+        cascade (w, level, slot_of (level, w->base));
+
+      /* Detach this tick's elements and move on to the next tick
+         before calling ACTION, so that anything it reinserts
+         with a past expiry lands in the next tick's slot instead
+         of this one. */
+      list_init (&expired);
+      while (!list_empty (list))
+        list_push_back (&expired, list_pop_front (list));
+      map_clear (w, 0, slot);
+      w->base++;
+
+      while (!list_empty (&expired))
+        {
+          struct wheel_elem *e = list_entry (list_pop_front (&expired),
+                                             struct wheel_elem, list_elem);
+          w->elem_cnt--;
+          action (e, aux);
+        }
+    }
+}
+
+/* Returns a tick no later than the earliest expiry in W, or
+   INT64_MAX if W is empty: the first tick at which
+   wheel_advance() has an element to expire or a slot to
+   cascade.  Above level 0 only the slot an element is in is
+   known, not where in it the element falls, so the tick
+   returned may come before anything is due.  A caller that
+   waits for it should advance W and ask again, which happens at
+   most once per level for each element.  Takes time independent
+   of the number of elements. */
+int64_t
+wheel_next_expiry (const struct wheel *w)
+{
+  ASSERT (w != NULL);
+
+  return next_event (w);
+}
+
+/* Returns the number of elements in W. */
+size_t
+wheel_size (const struct wheel *w)
+{
+  return w->elem_cnt;
+}
+
+/* Returns true if W holds no elements. */
+bool
+wheel_empty (const struct wheel *w)
+{
+  return w->elem_cnt == 0;
+}
@@ -0,0 +1,76 @@
+#ifndef __LIB_KERNEL_WHEEL_H
+#define __LIB_KERNEL_WHEEL_H
+
+/* Hierarchical timing wheel.
+
+   A timing wheel keeps elements keyed by an expiry time, in
+   ticks, and hands them back once that time has passed.  It is
+   organized like the digits of a clock: level 0 has one slot per
+   tick for the next WHEEL_SLOTS ticks, level 1 has one slot per
+   WHEEL_SLOTS ticks for the next WHEEL_SLOTS^2 ticks, and so on.
+   An element is filed in the lowest level whose range covers its
+   expiry.  Whenever level 0 wraps around, the next slot of level
+   1 is emptied and its elements are refiled one level down, and
+   likewise further up.
+
+   Insertion and removal are O(1).  Advancing the wheel is O(1)
+   amortized per element, because an element is refiled at most
+   once per level before it expires, and ticks in between are
+   skipped by way of one bitmap per level.  The wheel does not
+   track its exact next expiry; wheel_next_expiry() returns the
+   next tick at which it has to be advanced, a lower bound on
+   that expiry, from the bitmaps alone.
+
+   Like lists and hash tables, the wheel does no dynamic
+   allocation: each structure that can be in a wheel embeds a
+   struct wheel_elem, and wheel_entry() converts back to it. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "list.h"
+
+/* Geometry.  4 levels of 64 slots cover 2^24 ticks (about 46
+   hours at 100 Hz); later expiries wait in the top level and are
+   refiled until they come into range. */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+
+/* Wheel element. */
+struct wheel_elem
+  {
+    struct list_elem list_elem;         /* Element in a slot list. */
+    int64_t expires;                    /* Expiry time, in ticks. */
+    int slot;                           /* Level * WHEEL_SLOTS + slot. */
+  };
+
+/* Converts pointer to wheel element WHEEL_ELEM into a pointer to
+   the structure that WHEEL_ELEM is embedded inside. */
+#define wheel_entry(WHEEL_ELEM, STRUCT, MEMBER)                 \
+        ((STRUCT *) ((uint8_t *) &(WHEEL_ELEM)->list_elem       \
+                     - offsetof (STRUCT, MEMBER.list_elem)))
+
+/* Performs some operation on expired wheel element E, given
+   auxiliary data AUX. */
+typedef void wheel_action_func (struct wheel_elem *e, void *aux);
+
+/* Timing wheel. */
+struct wheel
+  {
+    int64_t base;                       /* Next tick to process. */
+    size_t elem_cnt;                    /* Number of elements. */
+    uint32_t map[WHEEL_LEVELS][WHEEL_SLOTS / 32]; /* Non-empty slots. */
+    struct list slots[WHEEL_LEVELS][WHEEL_SLOTS];
+  };
+
+void wheel_init (struct wheel *, int64_t now);
+void wheel_insert (struct wheel *, struct wheel_elem *, int64_t expires);
+void wheel_remove (struct wheel *, struct wheel_elem *);
+void wheel_advance (struct wheel *, int64_t now,
+                    wheel_action_func *, void *aux);
+int64_t wheel_next_expiry (const struct wheel *);
+size_t wheel_size (const struct wheel *);
+bool wheel_empty (const struct wheel *);
+
+#endif /* lib/kernel/wheel.h */
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/thread.h"
+#include "threads/synch.h"
+#include "threads/tsc.h"
+#include "devices/timer.h"
+
+#include "projects/lockbench/lockbench.h"
+
+/* Measures acquire/release pairs per second on a lock, against a
+   semaphore used as a mutex, which is what a lock used to be.
+   Uncontended, one thread takes and drops a free lock over and
+   over, so only the fast path runs.  Contended, several threads
+   share one lock and each sometimes yields while holding it, so
+   that the others queue up behind it and every release hands the
+   lock over through the slow path. */
+
+#define RUN_TICKS (TIMER_FREQ / 2)	/* Length of each run. */
+#define BATCH 1000			/* Pairs between clock checks. */
+#define CONTENDER_CNT 4			/* Threads in contended runs. */
+#define YIELD_EVERY 64			/* Pairs between yields. */
+
+struct contender
+{
+	bool use_sema;
+	uint64_t pairs;
+};
+
+static struct lock lock;
+static struct semaphore mutex;
+static int64_t start_time;
+static struct semaphore done;
+static uint64_t shared_counter;
+
+static void acquire (bool use_sema)
+{
+	if (use_sema)
+		sema_down (&mutex);
+	else
+		lock_acquire (&lock);
+}
+
+static void release (bool use_sema)
+{
+	if (use_sema)
+		sema_up (&mutex);
+	else
+		lock_release (&lock);
+}
+
+static void print_rate (const char *what, uint64_t pairs, int64_t ticks,
+			uint64_t cycles)
+{
+	printf ("lockbench: %-22s %9llu pairs/s, %5llu cycles/pair\n", what,
+		pairs * TIMER_FREQ / ticks, pairs > 0 ? cycles / pairs : 0);
+}
+
+/* Takes and drops a free lock, or MUTEX, for RUN_TICKS. */
+static void run_uncontended (bool use_sema)
+{
+	uint64_t pairs = 0, start_tsc;
+	int64_t elapsed;
+	int i;
+
+	start_time = timer_ticks ();
+	start_tsc = tsc_read ();
+	while ((elapsed = timer_elapsed (start_time)) < RUN_TICKS) {
+		for (i = 0; i < BATCH; i++) {
+			acquire (use_sema);
+			release (use_sema);
+		}
+		pairs += BATCH;
+	}
+	print_rate (use_sema ? "uncontended semaphore" : "uncontended lock",
+		    pairs, elapsed, tsc_read () - start_tsc);
+}
+
+static void contender_thread (void *__c)
+{
+	struct contender *c = (struct contender *) __c;
+
+	while (timer_elapsed (start_time) < RUN_TICKS) {
+		acquire (c->use_sema);
+		shared_counter++;
+		if (++c->pairs % YIELD_EVERY == 0)
+			thread_yield ();
+		release (c->use_sema);
+	}
+	sema_up (&done);
+}
+
+/* Runs CONTENDER_CNT threads that share the lock, or MUTEX, for
+   RUN_TICKS, and checks that none of their updates got lost. */
+static void run_contended (bool use_sema)
+{
+	static struct contender contenders[CONTENDER_CNT];
+	uint64_t pairs = 0, min = UINT64_MAX, max = 0, start_tsc;
+	int64_t elapsed;
+	int i;
+
+	sema_init (&done, 0);
+	shared_counter = 0;
+	start_time = timer_ticks ();
+	start_tsc = tsc_read ();
+	for (i = 0; i < CONTENDER_CNT; i++) {
+		struct contender *c = &contenders[i];
+
+		c->use_sema = use_sema;
+		c->pairs = 0;
+		if (thread_create ("contender", PRI_DEFAULT, contender_thread, c)
+		    == TID_ERROR)
+			PANIC ("lockbench: thread_create failed");
+	}
+	for (i = 0; i < CONTENDER_CNT; i++)
+		sema_down (&done);
+	elapsed = timer_elapsed (start_time);
+
+	for (i = 0; i < CONTENDER_CNT; i++) {
+		pairs += contenders[i].pairs;
+		if (contenders[i].pairs < min)
+			min = contenders[i].pairs;
+		if (contenders[i].pairs > max)
+			max = contenders[i].pairs;
+	}
+	if (shared_counter != pairs)
+		PANIC ("lockbench: lost updates: %llu of %llu pairs",
+		       shared_counter, pairs);
+	print_rate (use_sema ? "contended semaphore" : "contended lock",
+		    pairs, elapsed, tsc_read () - start_tsc);
+	printf ("lockbench: %-22s %d threads, %llu..%llu pairs each\n", "",
+		CONTENDER_CNT, min, max);
+}
+
+void run_lockbench(char **argv UNUSED)
+{
+	lock_init (&lock);
+	sema_init (&mutex, 1);
+
+	run_uncontended (false);
+	run_uncontended (true);
+	run_contended (false);
+	run_contended (true);
+}
@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_LOCKBENCH_LOCKBENCH_H__
+#define __PROJECTS_LOCKBENCH_LOCKBENCH_H__
+
+void run_lockbench(char **argv UNUSED);
+
+#endif
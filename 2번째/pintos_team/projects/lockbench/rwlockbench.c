@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/thread.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+
+#include "projects/lockbench/rwlockbench.h"
+
+/* Shows how readers of a read-mostly table scale with a
+   reader-writer lock compared with a plain lock.  Each reader
+   looks through the table over and over, and now and then
+   sleeps for a tick while it holds the lock, as if it had to
+   read a block from disk.  One writer rewrites the table every
+   WRITE_INTERVAL ticks.  A plain lock lets only one reader sleep
+   at a time; a reader-writer lock lets them all. */
+
+#define RUN_TICKS TIMER_FREQ		/* Length of each run. */
+#define MAX_READERS 8			/* Most readers per run. */
+#define TABLE_SIZE 64			/* Entries in the table. */
+#define SLEEP_EVERY 16			/* Reads between sleeps. */
+#define WRITE_INTERVAL 10		/* Ticks between writes. */
+
+static struct lock lock;
+static struct rwlock rwlock;
+static bool use_rwlock;
+
+static int table[TABLE_SIZE];
+static int64_t start_time;
+static struct semaphore done;
+static int64_t reads[MAX_READERS];
+static int64_t writes;
+
+static void read_lock (void)
+{
+	if (use_rwlock)
+		rwlock_acquire_read (&rwlock);
+	else
+		lock_acquire (&lock);
+}
+
+static void read_unlock (void)
+{
+	if (use_rwlock)
+		rwlock_release_read (&rwlock);
+	else
+		lock_release (&lock);
+}
+
+static void reader_thread (void *__idx)
+{
+	int idx = (int) __idx;
+	int i;
+
+	while (timer_elapsed (start_time) < RUN_TICKS) {
+		read_lock ();
+		for (i = 1; i < TABLE_SIZE; i++)
+			if (table[i] != table[0])
+				PANIC ("rwlockbench: read a torn table");
+		if (++reads[idx] % SLEEP_EVERY == 0)
+			timer_sleep (1);
+		read_unlock ();
+	}
+	sema_up (&done);
+}
+
+static void writer_thread (void *aux UNUSED)
+{
+	int i;
+
+	while (timer_elapsed (start_time) < RUN_TICKS) {
+		timer_sleep (WRITE_INTERVAL);
+		if (use_rwlock)
+			rwlock_acquire_write (&rwlock);
+		else
+			lock_acquire (&lock);
+		for (i = 0; i < TABLE_SIZE; i++)
+			table[i]++;
+		writes++;
+		if (use_rwlock)
+			rwlock_release_write (&rwlock);
+		else
+			lock_release (&lock);
+	}
+	sema_up (&done);
+}
+
+/* Runs READER_CNT readers and one writer for RUN_TICKS and
+   returns the reads per second. */
+static int64_t run (bool rw, int reader_cnt)
+{
+	int64_t total = 0, elapsed;
+	int i;
+
+	use_rwlock = rw;
+	writes = 0;
+	sema_init (&done, 0);
+	start_time = timer_ticks ();
+	for (i = 0; i < reader_cnt; i++) {
+		reads[i] = 0;
+		if (thread_create ("reader", PRI_DEFAULT, reader_thread,
+				   (void *) i) == TID_ERROR)
+			PANIC ("rwlockbench: thread_create failed");
+	}
+	if (thread_create ("writer", PRI_DEFAULT, writer_thread, NULL)
+	    == TID_ERROR)
+		PANIC ("rwlockbench: thread_create failed");
+	for (i = 0; i < reader_cnt + 1; i++)
+		sema_down (&done);
+	elapsed = timer_elapsed (start_time);
+
+	for (i = 0; i < reader_cnt; i++)
+		total += reads[i];
+	return total * TIMER_FREQ / elapsed;
+}
+
+void run_rwlockbench(char **argv UNUSED)
+{
+	int reader_cnt;
+
+	lock_init (&lock);
+	rwlock_init (&rwlock);
+
+	printf ("rwlockbench: readers   lock reads/s rwlock reads/s  speedup\n");
+	for (reader_cnt = 1; reader_cnt <= MAX_READERS; reader_cnt *= 2) {
+		int64_t plain = run (false, reader_cnt);
+		int64_t shared = run (true, reader_cnt);
+
+		printf ("rwlockbench: %7d %14lld %14lld %7lld.%02lldx\n",
+			reader_cnt, plain, shared,
+			plain > 0 ? shared / plain : 0,
+			plain > 0 ? shared * 100 / plain % 100 : 0);
+	}
+}
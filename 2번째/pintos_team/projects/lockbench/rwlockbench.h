@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_LOCKBENCH_RWLOCKBENCH_H__
+#define __PROJECTS_LOCKBENCH_RWLOCKBENCH_H__
+
+void run_rwlockbench(char **argv UNUSED);
+
+#endif
@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+
+#include "projects/lockbench/synchtest.h"
+
+/* Checks barriers and sema_down_any().  Runs several rounds of a
+   barrier, checking that nobody leaves a round early and that
+   exactly the last arriver is told so, then wakes threads in
+   sema_down_any() through each of their semaphores, with an up
+   that comes before the wait, and with several waiters at once.
+   Panics on the first failure.  A lost wakeup is reported once
+   TIMEOUT ticks pass without it. */
+
+#define THREAD_CNT 4			/* Threads at the barrier. */
+#define ROUNDS 6			/* Barrier rounds. */
+#define SEMA_CNT 3			/* Semaphores waited on at once. */
+#define TIMEOUT TIMER_FREQ		/* Ticks to wait for a wakeup. */
+
+static struct semaphore done;
+
+static struct barrier barrier;
+static int arrived[ROUNDS];		/* Threads that reached each round. */
+static int last_cnt[ROUNDS];		/* barrier_wait() returns of true. */
+
+static struct semaphore semas[SEMA_CNT];
+static struct semaphore *sema_set[SEMA_CNT];
+static int results[SEMA_CNT];		/* sema_down_any() return, by thread. */
+
+/* Waits until CNT threads have upped DONE, or panics if they take
+   longer than TIMEOUT ticks. */
+static void wait_for (int cnt, const char *what)
+{
+	int64_t start = timer_ticks ();
+
+	while (cnt > 0) {
+		if (sema_try_down (&done))
+			cnt--;
+		else if (timer_elapsed (start) > TIMEOUT)
+			PANIC ("synchtest: %s: lost a wakeup", what);
+		else
+			timer_sleep (1);
+	}
+}
+
+static void barrier_thread (void *__idx)
+{
+	int idx = (int) __idx;
+	int round;
+
+	for (round = 0; round < ROUNDS; round++) {
+		enum intr_level old_level;
+		bool last;
+		int pos;
+
+		/* Arrive in a different order each round. */
+		timer_sleep ((idx + round) % THREAD_CNT);
+
+		/* Arrive with interrupts off, so that POS is really this
+		   thread's place in line. */
+		old_level = intr_disable ();
+		pos = ++arrived[round];
+		last = barrier_wait (&barrier);
+		if (last)
+			last_cnt[round]++;
+		intr_set_level (old_level);
+
+		if (last != (pos == THREAD_CNT))
+			PANIC ("synchtest: barrier: arrival %d of %d returned %s",
+			       pos, THREAD_CNT, last ? "true" : "false");
+		if (arrived[round] != THREAD_CNT)
+			PANIC ("synchtest: barrier: left round %d with %d of %d "
+			       "arrived", round, arrived[round], THREAD_CNT);
+	}
+	sema_up (&done);
+}
+
+static void test_barrier (void)
+{
+	int i;
+
+	barrier_init (&barrier, THREAD_CNT);
+	memset (arrived, 0, sizeof arrived);
+	memset (last_cnt, 0, sizeof last_cnt);
+	for (i = 0; i < THREAD_CNT; i++)
+		if (thread_create ("barrier", PRI_DEFAULT, barrier_thread,
+				   (void *) i) == TID_ERROR)
+			PANIC ("synchtest: thread_create failed");
+	wait_for (THREAD_CNT, "barrier");
+
+	for (i = 0; i < ROUNDS; i++)
+		if (last_cnt[i] != 1)
+			PANIC ("synchtest: barrier: round %d had %d last arrivers",
+			       i, last_cnt[i]);
+	printf ("synchtest: barrier: %d threads, %d rounds: ok\n",
+		THREAD_CNT, ROUNDS);
+}
+
+static void any_thread (void *__idx)
+{
+	int idx = (int) __idx;
+
+	results[idx] = sema_down_any (sema_set, SEMA_CNT);
+	sema_up (&done);
+}
+
+/* Starts CNT threads in sema_down_any() and gives them time to
+   block. */
+static void start_waiters (int cnt)
+{
+	int i;
+
+	for (i = 0; i < SEMA_CNT; i++)
+		results[i] = -1;
+	for (i = 0; i < cnt; i++)
+		if (thread_create ("any", PRI_DEFAULT, any_thread, (void *) i)
+		    == TID_ERROR)
+			PANIC ("synchtest: thread_create failed");
+	timer_sleep (2);
+}
+
+/* Checks that no semaphore was left up or taken twice. */
+static void check_semas (const char *what)
+{
+	int i;
+
+	for (i = 0; i < SEMA_CNT; i++)
+		if (semas[i].value != 0)
+			PANIC ("synchtest: %s: semaphore %d left at %u",
+			       what, i, semas[i].value);
+}
+
+static void test_sema_down_any (void)
+{
+	int seen[SEMA_CNT];
+	int i;
+
+	for (i = 0; i < SEMA_CNT; i++) {
+		sema_init (&semas[i], 0);
+		sema_set[i] = &semas[i];
+	}
+
+	/* One waiter, woken through each semaphore in turn. */
+	for (i = 0; i < SEMA_CNT; i++) {
+		start_waiters (1);
+		sema_up (&semas[i]);
+		wait_for (1, "sema_down_any");
+		if (results[0] != i)
+			PANIC ("synchtest: up on semaphore %d woke sema_down_any() "
+			       "for %d", i, results[0]);
+		check_semas ("sema_down_any");
+	}
+	printf ("synchtest: sema_down_any: woken through each of %d: ok\n",
+		SEMA_CNT);
+
+	/* An up before the wait must not be lost. */
+	sema_up (&semas[SEMA_CNT - 1]);
+	start_waiters (1);
+	wait_for (1, "up before wait");
+	if (results[0] != SEMA_CNT - 1)
+		PANIC ("synchtest: up before wait: got %d", results[0]);
+	check_semas ("up before wait");
+	printf ("synchtest: sema_down_any: up before wait: ok\n");
+
+	/* Several waiters, one up on each semaphore: every up must
+	   wake a different waiter, each taking the up that woke it. */
+	start_waiters (SEMA_CNT);
+	for (i = 0; i < SEMA_CNT; i++)
+		sema_up (&semas[i]);
+	wait_for (SEMA_CNT, "several waiters");
+	memset (seen, 0, sizeof seen);
+	for (i = 0; i < SEMA_CNT; i++)
+		if (results[i] < 0 || results[i] >= SEMA_CNT
+		    || seen[results[i]]++ != 0)
+			PANIC ("synchtest: several waiters: waiter %d got %d",
+			       i, results[i]);
+	check_semas ("several waiters");
+
+	/* Several waiters, all woken through the same semaphore. */
+	start_waiters (SEMA_CNT);
+	for (i = 0; i < SEMA_CNT; i++)
+		sema_up (&semas[1]);
+	wait_for (SEMA_CNT, "one semaphore");
+	for (i = 0; i < SEMA_CNT; i++)
+		if (results[i] != 1)
+			PANIC ("synchtest: one semaphore: waiter %d got %d",
+			       i, results[i]);
+	check_semas ("one semaphore");
+	printf ("synchtest: sema_down_any: %d waiters at once: ok\n",
+		SEMA_CNT);
+}
+
+void run_synchtest(char **argv UNUSED)
+{
+	sema_init (&done, 0);
+	test_barrier ();
+	test_sema_down_any ();
+	printf ("synchtest: pass\n");
+}
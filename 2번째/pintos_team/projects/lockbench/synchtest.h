@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_LOCKBENCH_SYNCHTEST_H__
+#define __PROJECTS_LOCKBENCH_SYNCHTEST_H__
+
+void run_synchtest(char **argv UNUSED);
+
+#endif
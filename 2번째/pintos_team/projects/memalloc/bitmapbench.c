@@ -0,0 +1,154 @@
+#include <bitmap.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/malloc.h"
+#include "threads/tsc.h"
+
+#include "projects/memalloc/bitmapbench.h"
+
+/* Compares the bitmap range operations, which work a whole
+   element at a time, with the bit-at-a-time loops they
+   replaced, kept below, on a large bitmap, and checks that both
+   give the same answers. */
+
+#define BIT_CNT (256 * 1024)		/* Bits in the bitmap. */
+#define REPEAT 8			/* Runs of each operation. */
+#define GAP 32				/* Used bit every GAP bits. */
+#define RUN 64				/* Free run to scan for. */
+
+/* The bit-at-a-time versions. */
+
+static void old_set_multiple (struct bitmap *b, size_t start, size_t cnt,
+			      bool value)
+{
+	size_t i;
+
+	for (i = 0; i < cnt; i++)
+		bitmap_set (b, start + i, value);
+}
+
+static size_t old_count (const struct bitmap *b, size_t start, size_t cnt,
+			 bool value)
+{
+	size_t i, value_cnt = 0;
+
+	for (i = 0; i < cnt; i++)
+		if (bitmap_test (b, start + i) == value)
+			value_cnt++;
+	return value_cnt;
+}
+
+static bool old_contains (const struct bitmap *b, size_t start, size_t cnt,
+			  bool value)
+{
+	size_t i;
+
+	for (i = 0; i < cnt; i++)
+		if (bitmap_test (b, start + i) == value)
+			return true;
+	return false;
+}
+
+static size_t old_scan (const struct bitmap *b, size_t start, size_t cnt,
+			bool value)
+{
+	size_t i;
+
+	for (i = start; i + cnt <= bitmap_size (b); i++)
+		if (!old_contains (b, i, cnt, !value))
+			return i;
+	return BITMAP_ERROR;
+}
+
+/* Sets every GAP'th bit of B, so that no run of RUN clear bits
+   exists until the last 2 * RUN bits, which are all clear. */
+static void fill (struct bitmap *b)
+{
+	size_t i;
+
+	bitmap_set_all (b, false);
+	for (i = 0; i < BIT_CNT - 2 * RUN; i += GAP)
+		bitmap_mark (b, i);
+}
+
+static void report (const char *what, uint64_t old_cycles,
+		    uint64_t new_cycles)
+{
+	if (new_cycles == 0)
+		new_cycles = 1;
+	printf ("bitmapbench: %-14s old %10llu cycles, new %9llu cycles, "
+		"%4llux faster\n", what, old_cycles / REPEAT,
+		new_cycles / REPEAT, old_cycles / new_cycles);
+}
+
+void run_bitmapbench(char **argv UNUSED)
+{
+	struct bitmap *b = bitmap_create (BIT_CNT);
+	uint64_t old_cycles = 0, new_cycles = 0, start;
+	size_t old_result = 0, new_result = 0;
+	int i;
+
+	if (b == NULL)
+		PANIC ("bitmapbench: out of memory");
+	printf ("bitmapbench: %d bits, %d runs each\n", BIT_CNT, REPEAT);
+
+	/* Odd bounds, so that both edges are partial elements. */
+	for (i = 0; i < REPEAT; i++) {
+		start = tsc_read ();
+		old_set_multiple (b, 3, BIT_CNT - 5, i % 2 == 0);
+		old_cycles += tsc_read () - start;
+		start = tsc_read ();
+		bitmap_set_multiple (b, 3, BIT_CNT - 5, i % 2 == 0);
+		new_cycles += tsc_read () - start;
+	}
+	report ("set_multiple", old_cycles, new_cycles);
+
+	fill (b);
+	old_cycles = new_cycles = 0;
+	for (i = 0; i < REPEAT; i++) {
+		start = tsc_read ();
+		old_result = old_count (b, 1, BIT_CNT - 1, true);
+		old_cycles += tsc_read () - start;
+		start = tsc_read ();
+		new_result = bitmap_count (b, 1, BIT_CNT - 1, true);
+		new_cycles += tsc_read () - start;
+	}
+	if (old_result != new_result)
+		PANIC ("bitmapbench: count %zu != %zu", new_result, old_result);
+	report ("count", old_cycles, new_cycles);
+
+	/* No set bit past the filled part: the whole range is read. */
+	old_cycles = new_cycles = 0;
+	for (i = 0; i < REPEAT; i++) {
+		bool old_any, new_any;
+
+		bitmap_set_all (b, false);
+		start = tsc_read ();
+		old_any = old_contains (b, 1, BIT_CNT - 1, true);
+		old_cycles += tsc_read () - start;
+		start = tsc_read ();
+		new_any = bitmap_contains (b, 1, BIT_CNT - 1, true);
+		new_cycles += tsc_read () - start;
+		if (old_any || new_any)
+			PANIC ("bitmapbench: contains found a bit in a clear map");
+	}
+	report ("contains", old_cycles, new_cycles);
+
+	/* First fit, as bitmap_scan() does it. */
+	fill (b);
+	old_cycles = new_cycles = 0;
+	for (i = 0; i < REPEAT; i++) {
+		start = tsc_read ();
+		old_result = old_scan (b, 0, RUN, false);
+		old_cycles += tsc_read () - start;
+		start = tsc_read ();
+		new_result = bitmap_scan (b, 0, RUN, false);
+		new_cycles += tsc_read () - start;
+	}
+	if (old_result != new_result)
+		PANIC ("bitmapbench: scan %zu != %zu", new_result, old_result);
+	report ("scan", old_cycles, new_cycles);
+
+	bitmap_destroy (b);
+}
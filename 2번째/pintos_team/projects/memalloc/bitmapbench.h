@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_MEMALLOC_BITMAPBENCH_H__
+#define __PROJECTS_MEMALLOC_BITMAPBENCH_H__
+
+void run_bitmapbench(char **argv UNUSED);
+
+#endif
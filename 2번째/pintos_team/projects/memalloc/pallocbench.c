@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/palloc.h"
+#include "threads/tsc.h"
+
+#include "projects/memalloc/pallocbench.h"
+
+/* Drives the user pool with a random mix of page allocations and
+   frees, the same sequence for every allocator, and reports the
+   cycles each call takes and how fragmented the pool gets.
+   Choose the user pool's allocator with -ma=K,U to compare them.
+
+   Fragmentation is 1 - (longest free run / free pages), sampled
+   every SAMPLE_EVERY operations: 0% means all free pages are in
+   one piece.  A failure is a request that did not fit, though
+   usually enough pages were free in total. */
+
+#define SLOT_CNT 64			/* Most live allocations. */
+#define OP_CNT 20000			/* Operations per run. */
+#define SAMPLE_EVERY 500		/* Operations between samples. */
+
+static const char *allocator_names[] = {
+	"first fit", "next fit", "best fit", "buddy",
+};
+
+struct slot
+{
+	void *pages;
+	size_t page_cnt;
+};
+
+/* The benchmark's own generator, so that every run sees the same
+   requests whatever else uses random_ulong(). */
+static unsigned long seed;
+
+static unsigned long next_random (void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+/* Returns a request size: mostly single pages, some small
+   multi-page requests, and a few large ones. */
+static size_t random_size (void)
+{
+	unsigned long r = next_random () % 100;
+
+	if (r < 70)
+		return 1;
+	else if (r < 90)
+		return 2 + next_random () % 7;
+	else
+		return 9 + next_random () % 56;
+}
+
+void run_pallocbench(char **argv UNUSED)
+{
+	static struct slot slots[SLOT_CNT];
+	uint64_t get_cycles = 0, free_cycles = 0, max_get = 0;
+	unsigned get_cnt = 0, free_cnt = 0, fail_cnt = 0;
+	unsigned frag_sum = 0, frag_max = 0, sample_cnt = 0;
+	struct palloc_stats st;
+	int op, i;
+
+	seed = 1;
+	memset (slots, 0, sizeof slots);
+	for (op = 0; op < OP_CNT; op++) {
+		struct slot *s = &slots[next_random () % SLOT_CNT];
+		uint64_t start = tsc_read (), cycles;
+
+		if (s->pages != NULL) {
+			palloc_free_multiple (s->pages, s->page_cnt);
+			free_cycles += tsc_read () - start;
+			free_cnt++;
+			s->pages = NULL;
+		} else {
+			s->page_cnt = random_size ();
+			start = tsc_read ();
+			s->pages = palloc_get_multiple (PAL_USER, s->page_cnt);
+			cycles = tsc_read () - start;
+			get_cycles += cycles;
+			if (cycles > max_get)
+				max_get = cycles;
+			get_cnt++;
+			if (s->pages == NULL)
+				fail_cnt++;
+		}
+
+		if (op % SAMPLE_EVERY == SAMPLE_EVERY - 1) {
+			unsigned frag;
+
+			palloc_get_stats (PAL_USER, &st);
+			frag = (st.free_cnt > 0
+				? 100 - st.largest_free * 100 / st.free_cnt : 0);
+			frag_sum += frag;
+			if (frag > frag_max)
+				frag_max = frag;
+			sample_cnt++;
+		}
+	}
+	for (i = 0; i < SLOT_CNT; i++)
+		if (slots[i].pages != NULL)
+			palloc_free_multiple (slots[i].pages, slots[i].page_cnt);
+	palloc_get_stats (PAL_USER, &st);
+
+	printf ("pallocbench: allocator=%s pages=%zu ops=%d\n",
+		user_pallocator < sizeof allocator_names / sizeof *allocator_names
+		? allocator_names[user_pallocator] : "?", st.page_cnt, OP_CNT);
+	printf ("pallocbench: get %llu cycles avg, %llu max; "
+		"free %llu cycles avg; %u of %u gets failed\n",
+		get_cnt > 0 ? get_cycles / get_cnt : 0, max_get,
+		free_cnt > 0 ? free_cycles / free_cnt : 0, fail_cnt, get_cnt);
+	printf ("pallocbench: fragmentation %u%% avg, %u%% max; "
+		"%zu of %zu pages free after the run\n",
+		sample_cnt > 0 ? frag_sum / sample_cnt : 0, frag_max,
+		st.free_cnt, st.page_cnt);
+}
@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_MEMALLOC_PALLOCBENCH_H__
+#define __PROJECTS_MEMALLOC_PALLOCBENCH_H__
+
+void run_pallocbench(char **argv UNUSED);
+
+#endif
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/group.h"
+#include "threads/thread.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+#include "projects/scheduling/grouptest.h"
+
+/* Runs CPU-bound threads in three CPU groups of equal weight:
+   "many" with MANY_CNT threads, "one" with a single thread, and
+   "capped" with a single thread and a quota of CAPPED_QUOTA
+   ticks per period.  Without groups, "many" would get most of
+   the CPU; with them, "capped" gets its quota and the other two
+   split the rest evenly, whatever their thread counts. */
+
+#define MANY_CNT 8
+#define CAPPED_QUOTA 20			/* Ticks per GROUP_PERIOD. */
+#define RUN_TICKS (5 * TIMER_FREQ)	/* Length of the test. */
+
+struct tenant
+{
+	const char *name;
+	int quota;
+	int thread_cnt;
+	struct thread_group *group;
+	int64_t cpu_ticks;		/* Summed over its threads. */
+};
+
+static int64_t start_time;
+static struct semaphore done;
+static struct lock tally_lock;		/* Protects tenants' cpu_ticks. */
+
+static void hog_thread (void *__tn)
+{
+	struct tenant *tn = (struct tenant *) __tn;
+	struct thread *cur = thread_current ();
+
+	while (timer_elapsed (start_time) < RUN_TICKS)
+		continue;
+
+	/* The groups' statistics count ticks too, but these only
+	   count the ticks of this test.  The other threads of the
+	   tenant are adding theirs, so add under a lock. */
+	lock_acquire (&tally_lock);
+	tn->cpu_ticks += cur->stats.cpu_ticks;
+	lock_release (&tally_lock);
+	sema_up (&done);
+}
+
+void run_group_test(char **argv UNUSED)
+{
+	static struct tenant tenants[] = {
+		{"many", 0, MANY_CNT, NULL, 0},
+		{"one", 0, 1, NULL, 0},
+		{"capped", CAPPED_QUOTA, 1, NULL, 0},
+	};
+	const int tenant_cnt = sizeof tenants / sizeof *tenants;
+	struct thread_group *saved = thread_current ()->group;
+	int64_t total = 0;
+	int i, j, thread_cnt = 0;
+
+	sema_init (&done, 0);
+	lock_init (&tally_lock);
+	start_time = timer_ticks ();
+	for (i = 0; i < tenant_cnt; i++) {
+		struct tenant *tn = &tenants[i];
+
+		tn->cpu_ticks = 0;
+		tn->group = group_create (tn->name, NULL, GROUP_WEIGHT_DEFAULT,
+					  tn->quota);
+		if (tn->group == NULL)
+			PANIC ("groups: out of groups");
+
+		/* New threads join their creator's group. */
+		thread_set_group (tn->group);
+		for (j = 0; j < tn->thread_cnt; j++)
+			thread_create (tn->name, PRI_DEFAULT, hog_thread, tn);
+		thread_cnt += tn->thread_cnt;
+	}
+	thread_set_group (saved);
+
+	for (i = 0; i < thread_cnt; i++)
+		sema_down (&done);
+
+	for (i = 0; i < tenant_cnt; i++)
+		total += tenants[i].cpu_ticks;
+	for (i = 0; i < tenant_cnt; i++)
+		printf ("groups: %-6s %d threads, quota %2d: %5lld ticks, %3lld%%\n",
+			tenants[i].name, tenants[i].thread_cnt, tenants[i].quota,
+			tenants[i].cpu_ticks,
+			total > 0 ? tenants[i].cpu_ticks * 100 / total : 0);
+	group_print_stats ();
+}
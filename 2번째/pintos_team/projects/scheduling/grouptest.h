@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_SCHEDULING_GROUPTEST_H__
+#define __PROJECTS_SCHEDULING_GROUPTEST_H__
+
+void run_group_test(char **argv UNUSED);
+
+#endif
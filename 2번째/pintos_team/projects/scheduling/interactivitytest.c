@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/thread.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+#include "projects/scheduling/interactivitytest.h"
+
+/* Runs an interactive thread, which sleeps for a tick or two at
+   a time and does almost no work when it wakes, and a semi-
+   interactive one, which runs several ticks between sleeps,
+   against a few CPU hogs.  For each, reports how long it sat in
+   the ready queue between its timer_sleep() expiring and getting
+   the CPU back.
+
+   Under the MFQ, the interactive thread never uses up a slice,
+   so it is boosted on every wakeup until it sits above the hogs
+   and runs as soon as it wakes.  The semi-interactive thread
+   uses up its slices and is demoted, and waits behind the hogs
+   for its turn. */
+
+#define HOG_CNT 4
+#define RUN_TICKS (5 * TIMER_FREQ)	/* Length of the test. */
+#define SLEEP_TICKS 2			/* Sleep between bursts. */
+#define SEMI_SPIN_TICKS 6		/* Burst of the semi-interactive thread. */
+
+struct sleeper_info
+{
+	const char *name;
+	int spin_ticks;			/* Ticks to spin after each wakeup. */
+	int64_t start_time;
+	int wakeups;
+	uint64_t total_latency;		/* Cycles spent ready after waking. */
+	uint64_t max_latency;
+	int priority;			/* Priority at the end. */
+	struct thread_stats stats;	/* Statistics at the end. */
+	struct semaphore sema_join;
+};
+
+struct hog_info
+{
+	int64_t start_time;
+	int priority;
+	struct semaphore sema_join;
+};
+
+static void spin (int64_t ticks)
+{
+	int64_t start = timer_ticks ();
+
+	while (timer_elapsed (start) < ticks)
+		continue;
+}
+
+static void hog_thread (void *__hi)
+{
+	struct hog_info *hi = (struct hog_info *) __hi;
+
+	while (timer_elapsed (hi->start_time) < RUN_TICKS)
+		continue;
+	hi->priority = thread_get_priority ();
+	sema_up (&hi->sema_join);
+}
+
+/* The time a thread spends READY is added to its ready_cycles
+   when it next runs, so the growth of ready_cycles across
+   timer_sleep() is its wakeup-to-run latency. */
+static void sleeper_thread (void *__si)
+{
+	struct sleeper_info *si = (struct sleeper_info *) __si;
+	struct thread *cur = thread_current ();
+
+	while (timer_elapsed (si->start_time) < RUN_TICKS) {
+		uint64_t before = cur->stats.ready_cycles;
+		uint64_t latency;
+
+		timer_sleep (SLEEP_TICKS);
+		latency = cur->stats.ready_cycles - before;
+		si->wakeups++;
+		si->total_latency += latency;
+		if (latency > si->max_latency)
+			si->max_latency = latency;
+		spin (si->spin_ticks);
+	}
+	si->priority = thread_get_priority ();
+	si->stats = cur->stats;
+	sema_up (&si->sema_join);
+}
+
+static void print_sleeper (const struct sleeper_info *si)
+{
+	printf ("interactivity: %-11s %4d wakeups, latency avg %9llu "
+		"max %9llu cycles, priority %2d, %u boosts, %u demotions\n",
+		si->name, si->wakeups,
+		si->wakeups > 0 ? si->total_latency / si->wakeups : 0,
+		si->max_latency, si->priority, si->stats.boosts,
+		si->stats.demotions);
+}
+
+void run_interactivity_test(char **argv UNUSED)
+{
+	struct hog_info hogs[HOG_CNT];
+	struct sleeper_info interactive, semi;
+	int64_t start_time;
+	int i;
+
+	printf ("interactivity: %d hogs at priority %d for %d ticks\n",
+		HOG_CNT, PRI_DEFAULT, RUN_TICKS);
+
+	start_time = timer_ticks ();
+	for (i = 0; i < HOG_CNT; i++) {
+		hogs[i].start_time = start_time;
+		sema_init (&hogs[i].sema_join, 0);
+		thread_create ("hog", PRI_DEFAULT, hog_thread, &hogs[i]);
+	}
+
+	memset (&interactive, 0, sizeof interactive);
+	interactive.name = "interactive";
+	interactive.spin_ticks = 0;
+	interactive.start_time = start_time;
+	sema_init (&interactive.sema_join, 0);
+	thread_create ("interactive", PRI_DEFAULT, sleeper_thread, &interactive);
+
+	memset (&semi, 0, sizeof semi);
+	semi.name = "semi";
+	semi.spin_ticks = SEMI_SPIN_TICKS;
+	semi.start_time = start_time;
+	sema_init (&semi.sema_join, 0);
+	thread_create ("semi", PRI_DEFAULT, sleeper_thread, &semi);
+
+	sema_down (&interactive.sema_join);
+	sema_down (&semi.sema_join);
+	for (i = 0; i < HOG_CNT; i++)
+		sema_down (&hogs[i].sema_join);
+
+	print_sleeper (&interactive);
+	print_sleeper (&semi);
+	for (i = 0; i < HOG_CNT; i++)
+		printf ("interactivity: hog %d ended at priority %d\n",
+			i, hogs[i].priority);
+}
@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_SCHEDULING_INTERACTIVITYTEST_H__
+#define __PROJECTS_SCHEDULING_INTERACTIVITYTEST_H__
+
+void run_interactivity_test(char **argv UNUSED);
+
+#endif
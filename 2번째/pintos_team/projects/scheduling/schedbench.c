@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/synch.h"
+#include "threads/tsc.h"
+#include "devices/timer.h"
+#include "projects/scheduling/schedbench.h"
+
+/* Scheduler benchmark.
+
+   Runs a mix of CPU-bound and sleep-bound threads, spread over
+   a number of priority levels, for a fixed time, and prints a
+   single line of KEY=VALUE pairs summing up how the scheduler
+   did, so that runs can be compared with each other:
+
+	sched		Scheduling class in use.
+	work/s		Work units done by CPU-bound threads per second.
+	ios/s		Sleep-and-burst cycles done per second.
+	fair		Jain's fairness index of the CPU time given to
+			the CPU-bound threads of each level, from 1/n
+			(one thread got all of it) to 1 (even shares).
+	lat_us		Percentiles of how long sleep-bound threads
+			waited, once woken, to get the CPU back.
+	vol, invol	Context switches of the benchmark threads.
+
+   The action takes one argument, a comma-separated list of
+   NAME=VALUE settings, or "-" for the defaults:
+
+	threads=N	Number of threads (default 20).
+	io=PCT		Percentage of them that are sleep-bound
+			(default 25).
+	levels=N	Number of priority levels used, starting
+			from 0 (default 5, or fewer if the scheduler
+			has fewer).
+	secs=N		Length of the run in seconds (default 5). */
+
+#define THREADS_MAX 64
+#define SAMPLES_MAX 8192	/* Latency samples kept. */
+#define WORK_ITERATIONS 1000	/* Loop iterations per work unit. */
+#define IO_SLEEP_TICKS 2	/* Sleep of a sleep-bound thread. */
+#define IO_BURST_UNITS 20	/* Work after each sleep. */
+
+struct bench_thread
+{
+	bool io;			/* Sleep-bound? */
+	int priority;
+	long long units;		/* Work units or sleep cycles done. */
+	struct thread_stats stats;	/* Statistics at the end. */
+};
+
+static struct bench_thread threads[THREADS_MAX];
+static int thread_cnt, io_pct, level_cnt, secs;
+static int64_t start_time, run_ticks;
+static struct latch start_gate, done;
+
+/* Wakeup-to-run latencies of sleep-bound threads, in cycles. */
+static uint64_t samples[SAMPLES_MAX];
+static size_t sample_cnt, samples_dropped;
+
+/* Does one unit of CPU-bound work. */
+static void do_work (void)
+{
+	volatile int i;
+
+	for (i = 0; i < WORK_ITERATIONS; i++)
+		continue;
+}
+
+static void add_sample (uint64_t latency)
+{
+	enum intr_level old_level = intr_disable ();
+
+	if (sample_cnt < SAMPLES_MAX)
+		samples[sample_cnt++] = latency;
+	else
+		samples_dropped++;
+	intr_set_level (old_level);
+}
+
+/* The time a thread spends READY is added to its ready_cycles
+   when it next runs, so the growth of ready_cycles across
+   timer_sleep() is its wakeup-to-run latency. */
+static void bench_thread (void *__bt)
+{
+	struct bench_thread *bt = (struct bench_thread *) __bt;
+	struct thread *cur = thread_current ();
+
+	latch_wait (&start_gate);
+	while (timer_elapsed (start_time) < run_ticks) {
+		if (bt->io) {
+			uint64_t before = cur->stats.ready_cycles;
+			int i;
+
+			timer_sleep (IO_SLEEP_TICKS);
+			add_sample (cur->stats.ready_cycles - before);
+			for (i = 0; i < IO_BURST_UNITS; i++)
+				do_work ();
+		} else
+			do_work ();
+		bt->units++;
+	}
+	bt->stats = cur->stats;
+	latch_count_down (&done);
+}
+
+/* Parses SPEC into the benchmark settings, panicking on a bad
+   one. */
+static void parse_spec (const char *spec)
+{
+	char buf[128], *token, *save_ptr;
+
+	thread_cnt = 20;
+	io_pct = 25;
+	level_cnt = PRI_MAX + 1 < 5 ? PRI_MAX + 1 : 5;
+	secs = 5;
+	if (!strcmp (spec, "-"))
+		return;
+
+	strlcpy (buf, spec, sizeof buf);
+	for (token = strtok_r (buf, ",", &save_ptr); token != NULL;
+	     token = strtok_r (NULL, ",", &save_ptr)) {
+		char *value = strchr (token, '=');
+
+		if (value == NULL)
+			PANIC ("schedbench: `%s' is not NAME=VALUE", token);
+		*value++ = '\0';
+		if (!strcmp (token, "threads"))
+			thread_cnt = atoi (value);
+		else if (!strcmp (token, "io"))
+			io_pct = atoi (value);
+		else if (!strcmp (token, "levels"))
+			level_cnt = atoi (value);
+		else if (!strcmp (token, "secs"))
+			secs = atoi (value);
+		else
+			PANIC ("schedbench: unknown setting `%s'", token);
+	}
+
+	if (thread_cnt < 1 || thread_cnt > THREADS_MAX)
+		PANIC ("schedbench: threads must be between 1 and %d", THREADS_MAX);
+	if (io_pct < 0 || io_pct > 100)
+		PANIC ("schedbench: io must be between 0 and 100");
+	if (level_cnt < 1 || level_cnt > PRI_MAX + 1)
+		PANIC ("schedbench: levels must be between 1 and %d", PRI_MAX + 1);
+	if (secs < 1)
+		PANIC ("schedbench: secs must be positive");
+}
+
+/* Prints Jain's fairness index of the CPU ticks received by the
+   CPU-bound threads at each priority level, as LEVEL:INDEX
+   pairs, skipping levels with no CPU-bound threads. */
+static void print_fairness (void)
+{
+	const char *sep = "";
+	int level, i;
+
+	printf (" fair=");
+	for (level = 0; level < level_cnt; level++) {
+		uint64_t sum = 0, sum_sq = 0, index;
+		int n = 0;
+
+		for (i = 0; i < thread_cnt; i++) {
+			uint64_t x = threads[i].stats.cpu_ticks;
+
+			if (threads[i].io || threads[i].priority != level)
+				continue;
+			sum += x;
+			sum_sq += x * x;
+			n++;
+		}
+		if (n == 0)
+			continue;
+
+		/* In thousandths; 1 if nobody ran at all. */
+		index = sum_sq > 0 ? sum * sum * 1000 / (n * sum_sq) : 1000;
+		printf ("%s%d:%llu.%03llu", sep, level, index / 1000, index % 1000);
+		sep = ",";
+	}
+	if (*sep == '\0')
+		printf ("-");
+}
+
+static int compare_u64 (const void *a_, const void *b_)
+{
+	const uint64_t *a = a_;
+	const uint64_t *b = b_;
+
+	return *a < *b ? -1 : *a > *b;
+}
+
+/* Returns percentile PCT of the first CNT sorted SAMPLES. */
+static uint64_t percentile (const uint64_t *samples, size_t cnt, int pct)
+{
+	return samples[(cnt - 1) * pct / 100];
+}
+
+/* Prints percentiles of the wakeup-to-run latency, converting
+   cycles to microseconds at CYCLES_PER_US. */
+static void print_latency (uint64_t cycles_per_us)
+{
+	static const int pcts[] = {50, 90, 99, 100};
+	size_t i;
+
+	printf (" lat_us=");
+	if (sample_cnt == 0) {
+		printf ("-");
+		return;
+	}
+	qsort (samples, sample_cnt, sizeof *samples, compare_u64);
+	for (i = 0; i < sizeof pcts / sizeof *pcts; i++)
+		printf ("%sp%d:%llu", i > 0 ? "," : "", pcts[i],
+			percentile (samples, sample_cnt, pcts[i]) / cycles_per_us);
+}
+
+void run_schedbench(char **argv)
+{
+	long long work = 0, ios = 0;
+	unsigned vol = 0, invol = 0;
+	uint64_t start_tsc, cycles_per_us;
+	int64_t elapsed;
+	int i;
+
+	parse_spec (argv[1]);
+	run_ticks = (int64_t) secs * TIMER_FREQ;
+	sample_cnt = samples_dropped = 0;
+	latch_init (&start_gate, 1);
+	latch_init (&done, thread_cnt);
+
+	/* Interleave sleep-bound threads with CPU-bound ones, so
+	   that both kinds are spread evenly over the levels. */
+	for (i = 0; i < thread_cnt; i++) {
+		struct bench_thread *bt = &threads[i];
+		char name[16];
+
+		memset (bt, 0, sizeof *bt);
+		bt->io = (i + 1) * io_pct / 100 > i * io_pct / 100;
+		bt->priority = i % level_cnt;
+		snprintf (name, sizeof name, "%s%d", bt->io ? "io" : "cpu", i);
+		if (thread_create (name, bt->priority, bench_thread, bt)
+		    == TID_ERROR)
+			PANIC ("schedbench: thread_create failed");
+	}
+
+	start_time = timer_ticks ();
+	start_tsc = tsc_read ();
+	latch_count_down (&start_gate);
+	latch_wait (&done);
+	elapsed = timer_elapsed (start_time);
+	cycles_per_us = (tsc_read () - start_tsc)
+			/ (elapsed * (1000000 / TIMER_FREQ));
+	if (cycles_per_us == 0)
+		cycles_per_us = 1;
+
+	for (i = 0; i < thread_cnt; i++) {
+		if (threads[i].io)
+			ios += threads[i].units;
+		else
+			work += threads[i].units;
+		vol += threads[i].stats.vol_switches;
+		invol += threads[i].stats.invol_switches;
+	}
+
+	printf ("schedbench: sched=%s threads=%d io=%d levels=%d secs=%d "
+		"ticks=%lld work/s=%lld ios/s=%lld",
+		thread_sched_name, thread_cnt, io_pct, level_cnt, secs,
+		elapsed, work * TIMER_FREQ / elapsed, ios * TIMER_FREQ / elapsed);
+	print_fairness ();
+	print_latency (cycles_per_us);
+	printf (" samples=%zu dropped=%zu vol=%u invol=%u\n",
+		sample_cnt, samples_dropped, vol, invol);
+}
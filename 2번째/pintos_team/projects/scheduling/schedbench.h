@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_SCHEDULING_SCHEDBENCH_H__
+#define __PROJECTS_SCHEDULING_SCHEDBENCH_H__
+
+void run_schedbench(char **argv);
+
+#endif
@@ -15,9 +15,11 @@ struct thread_info
 	int priority;
 	int64_t start_time;
 	int tick_count;
-	struct semaphore sema_join;
 };
 
+/* Opens once every thread has finished. */
+static struct latch join;
+
 static void load_thread (void *__ti) 
 {
 	struct thread_info *ti = (struct thread_info *) __ti;
@@ -35,7 +37,7 @@ static void load_thread (void *__ti)
 		last_time = cur_time;
 	}
 
-	sema_up(&ti->sema_join);
+	latch_count_down(&join);
 }
 
 
@@ -49,6 +51,7 @@ void run_scheduling_test(char **argv UNUSED)
 	struct thread_info info4[MAX_THREAD_CNT];
 	int64_t start_time;
 
+	latch_init(&join, 5 * MAX_THREAD_CNT);
 	start_time = timer_ticks();
 	for (i=0; i<MAX_THREAD_CNT; i++) {
 		struct thread_info *ti_0 = &info0[i];
@@ -62,31 +65,26 @@ void run_scheduling_test(char **argv UNUSED)
 		ti_0->priority = 0;
 		ti_0->start_time = start_time;
 		ti_0->tick_count = 0;
-		sema_init(&ti_0->sema_join, 0);
 
 		ti_1->id = i;
 		ti_1->priority = 1;
 		ti_1->start_time = start_time;
 		ti_1->tick_count = 0;
-		sema_init(&ti_1->sema_join, 0);
 
 		ti_2->id = i;
 		ti_2->priority = 2;
 		ti_2->start_time = start_time;
 		ti_2->tick_count = 0;
-		sema_init(&ti_2->sema_join, 0);
 
 		ti_3->id = i;
 		ti_3->priority = 3;
 		ti_3->start_time = start_time;
 		ti_3->tick_count = 0;
-		sema_init(&ti_3->sema_join, 0);
 
 		ti_4->id = i;
 		ti_4->priority = 4;
 		ti_4->start_time = start_time;
 		ti_4->tick_count = 0;
-		sema_init(&ti_4->sema_join, 0);
 
 		snprintf(name, sizeof name, "queue 0의 %d번" , i);
 		thread_create(name, 0, load_thread, ti_0);
@@ -103,12 +101,8 @@ void run_scheduling_test(char **argv UNUSED)
 	printf("Starting threads took %lld ticks.\n", timer_elapsed (start_time));
 	printf("Sleeping until threads join, please wait ... \n");
 
+	latch_wait(&join);
 	for (i=0; i<MAX_THREAD_CNT; i++) {
-		sema_down(&info0[i].sema_join);
-		sema_down(&info1[i].sema_join);
-		sema_down(&info2[i].sema_join);
-		sema_down(&info3[i].sema_join);
-		sema_down(&info4[i].sema_join);
 		printf("0번 큐 Thread %d received %d ticks.\n", i, info0[i].tick_count);
 		printf("1번 큐 Thread %d received %d ticks.\n", i, info1[i].tick_count);
 		printf("2번 큐 Thread %d received %d ticks.\n", i, info2[i].tick_count);
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "threads/thread.h"
+#include "threads/synch.h"
+#include "threads/tsc.h"
+
+#include "projects/threadbench/threadbench.h"
+
+/* Creates and tears down many short-lived threads, with and
+   without the thread page cache and through thread_create_many(),
+   and reports the cost of each in CPU cycles per thread. */
+
+#define THREAD_CNT 64		/* Threads per round. */
+#define ROUND_CNT 20		/* Rounds per mode. */
+
+static struct semaphore done;
+
+static void worker (void *aux UNUSED)
+{
+	sema_up (&done);
+}
+
+/* Runs ROUND_CNT rounds of THREAD_CNT threads, created one at a
+   time or in a batch, and prints the average cycles per thread
+   spent creating them and then running them to completion,
+   which includes freeing their pages. */
+static void run_mode (const char *mode, bool cache, bool batch)
+{
+	static void *aux[THREAD_CNT];
+	static tid_t tids[THREAD_CNT];
+	uint64_t create_cycles = 0, teardown_cycles = 0;
+	int round, i;
+
+	thread_page_cache = cache;
+	for (round = 0; round < ROUND_CNT; round++) {
+		uint64_t start, created;
+
+		sema_init (&done, 0);
+		start = tsc_read ();
+		if (batch) {
+			if (thread_create_many ("bench", PRI_DEFAULT, worker, aux,
+						THREAD_CNT, tids) != THREAD_CNT)
+				PANIC ("thread_create_many failed");
+		} else {
+			for (i = 0; i < THREAD_CNT; i++)
+				if (thread_create ("bench", PRI_DEFAULT, worker, NULL)
+				    == TID_ERROR)
+					PANIC ("thread_create failed");
+		}
+		created = tsc_read ();
+		for (i = 0; i < THREAD_CNT; i++)
+			sema_down (&done);
+
+		/* Let the last worker switch out and be freed. */
+		thread_yield ();
+
+		create_cycles += created - start;
+		teardown_cycles += tsc_read () - created;
+	}
+
+	printf ("threadbench: %-14s create %6llu cycles/thread, "
+		"run+teardown %6llu cycles/thread\n", mode,
+		create_cycles / (ROUND_CNT * THREAD_CNT),
+		teardown_cycles / (ROUND_CNT * THREAD_CNT));
+}
+
+void run_threadbench(char **argv UNUSED)
+{
+	bool saved = thread_page_cache;
+
+	printf ("threadbench: %d rounds of %d threads\n", ROUND_CNT, THREAD_CNT);
+	run_mode ("no cache", false, false);
+	run_mode ("cache", true, false);
+	run_mode ("cache+batch", true, true);
+	thread_page_cache = saved;
+}
@@ -0,0 +1,6 @@
+#ifndef __PROJECTS_THREADBENCH_THREADBENCH_H__
+#define __PROJECTS_THREADBENCH_THREADBENCH_H__
+
+void run_threadbench(char **argv UNUSED);
+
+#endif
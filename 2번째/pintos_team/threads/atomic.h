@@ -0,0 +1,26 @@
+#ifndef THREADS_ATOMIC_H
+#define THREADS_ATOMIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Atomic operations on a machine word.
+
+   Each is a single locked instruction, so it is atomic with
+   respect to interrupts on this CPU and to other CPUs, without
+   turning interrupts off.  Each is also a full memory barrier,
+   for both the compiler and the CPU.  See [IA32-v2a]
+   "CMPXCHG". */
+
+/* If *P equals OLD, sets *P to NEW and returns true.  Otherwise,
+   leaves *P alone and returns false. */
+static inline bool
+atomic_cmpxchg (volatile uintptr_t *p, uintptr_t old, uintptr_t new)
+{
+  uintptr_t prev;
+  asm volatile ("lock cmpxchgl %2, %1"
+                : "=a" (prev), "+m" (*p) : "r" (new), "0" (old) : "memory");
+  return prev == old;
+}
+
+#endif /* threads/atomic.h */
@@ -0,0 +1,192 @@
+#include "threads/buddy.h"
+#include <debug.h>
+#include <string.h>
+#include "threads/vaddr.h"
+
+/* For each page, ORDER holds the order of the free block that
+   starts at that page, or NOT_HEAD if no free block starts
+   there: the page is allocated or in the middle of a free
+   block. */
+#define NOT_HEAD 0xff
+
+static void free_block (struct buddy *, size_t page_idx, int order);
+
+/* Returns the free list element kept in page PAGE_IDX of B. */
+static struct list_elem *
+elem_at (struct buddy *b, size_t page_idx)
+{
+  return (struct list_elem *) (b->base + page_idx * PGSIZE);
+}
+
+/* Returns the index of the page that holds element E of B. */
+static size_t
+page_of (struct buddy *b, struct list_elem *e)
+{
+  return ((uint8_t *) e - b->base) / PGSIZE;
+}
+
+/* Returns the smallest order whose blocks hold PAGE_CNT pages. */
+static int
+order_for (size_t page_cnt)
+{
+  int order = 0;
+
+  while (((size_t) 1 << order) < page_cnt)
+    order++;
+  return order;
+}
+
+/* Returns the largest order of a block that can start at page
+   PAGE_IDX of B, given its alignment, and end by page END. */
+static int
+fit_order (const struct buddy *b, size_t page_idx, size_t end)
+{
+  size_t pfn = b->base_pfn + page_idx;
+  int order = 0;
+
+  while (order < BUDDY_MAX_ORDER
+         && pfn % ((size_t) 2 << order) == 0
+         && page_idx + ((size_t) 2 << order) <= end)
+    order++;
+  return order;
+}
+
+/* Returns the number of bytes that buddy_init() needs for a
+   buddy allocator of PAGE_CNT pages. */
+size_t
+buddy_buf_size (size_t page_cnt)
+{
+  return page_cnt;
+}
+
+/* Initializes B to manage the PAGE_CNT pages starting at BASE,
+   all free, keeping its per-page state in the BUF_SIZE bytes at
+   BUF, which must be at least buddy_buf_size(PAGE_CNT). */
+void
+buddy_init (struct buddy *b, void *base, size_t page_cnt,
+            void *buf, size_t buf_size)
+{
+  int order;
+
+  ASSERT (b != NULL);
+  ASSERT (pg_ofs (base) == 0);
+  ASSERT (buf_size >= buddy_buf_size (page_cnt));
+
+  b->base = base;
+  b->page_cnt = page_cnt;
+  b->base_pfn = pg_no (base);
+  b->order = buf;
+  memset (b->order, NOT_HEAD, page_cnt);
+  for (order = 0; order <= BUDDY_MAX_ORDER; order++)
+    list_init (&b->free[order]);
+  b->free_cnt = 0;
+
+  buddy_free (b, 0, page_cnt);
+}
+
+/* Allocates PAGE_CNT contiguous pages from B and returns the
+   index of the first one, or BUDDY_ERROR if no free block is
+   big enough.  The pages start at a multiple of the smallest
+   power of 2 not less than PAGE_CNT, counting in physical
+   pages. */
+size_t
+buddy_alloc (struct buddy *b, size_t page_cnt)
+{
+  int want, order;
+  size_t page_idx;
+
+  ASSERT (b != NULL);
+  ASSERT (page_cnt > 0);
+
+  want = order_for (page_cnt);
+  for (order = want; order <= BUDDY_MAX_ORDER; order++)
+    if (!list_empty (&b->free[order]))
+      break;
+  if (order > BUDDY_MAX_ORDER)
+    return BUDDY_ERROR;
+
+  page_idx = page_of (b, list_pop_front (&b->free[order]));
+  b->order[page_idx] = NOT_HEAD;
+  b->free_cnt -= (size_t) 1 << order;
+
+  /* Split off and free the upper halves until the block is
+     small enough.  A half's buddy is the block we keep, which
+     is not free, so the halves go straight on their lists. */
+  while (order > want)
+    {
+      size_t half;
+
+      order--;
+      half = page_idx + ((size_t) 1 << order);
+      b->order[half] = order;
+      list_push_front (&b->free[order], elem_at (b, half));
+      b->free_cnt += (size_t) 1 << order;
+    }
+
+  /* Give back the pages past PAGE_CNT. */
+  if (page_cnt < (size_t) 1 << want)
+    buddy_free (b, page_idx + page_cnt, ((size_t) 1 << want) - page_cnt);
+  return page_idx;
+}
+
+/* Frees the PAGE_CNT pages starting at PAGE_IDX in B.  They need
+   not be exactly one earlier allocation, but they must all be
+   allocated. */
+void
+buddy_free (struct buddy *b, size_t page_idx, size_t page_cnt)
+{
+  size_t end = page_idx + page_cnt;
+
+  ASSERT (b != NULL);
+  ASSERT (end <= b->page_cnt);
+
+  /* Free the range as the fewest aligned blocks that cover it. */
+  while (page_idx < end)
+    {
+      int order = fit_order (b, page_idx, end);
+
+      free_block (b, page_idx, order);
+      page_idx += (size_t) 1 << order;
+    }
+}
+
+/* Frees the block of order ORDER at PAGE_IDX in B, merging it
+   with its buddy, and the result with its own buddy, and so on,
+   as long as the buddy is a free block of the same order. */
+static void
+free_block (struct buddy *b, size_t page_idx, int order)
+{
+  b->free_cnt += (size_t) 1 << order;
+  while (order < BUDDY_MAX_ORDER)
+    {
+      size_t size = (size_t) 1 << order;
+      size_t buddy_pfn = (b->base_pfn + page_idx) ^ size;
+      size_t buddy_idx;
+
+      if (buddy_pfn < b->base_pfn)
+        break;
+      buddy_idx = buddy_pfn - b->base_pfn;
+      if (buddy_idx + size > b->page_cnt || b->order[buddy_idx] != order)
+        break;
+
+      list_remove (elem_at (b, buddy_idx));
+      b->order[buddy_idx] = NOT_HEAD;
+      if (buddy_idx < page_idx)
+        page_idx = buddy_idx;
+      order++;
+    }
+  b->order[page_idx] = order;
+  list_push_front (&b->free[order], elem_at (b, page_idx));
+}
+
+/* Returns the number of pages in the largest free block of B. */
+size_t
+buddy_largest_free (struct buddy *b)
+{
+  int order;
+
+  for (order = BUDDY_MAX_ORDER; order >= 0; order--)
+    if (!list_empty (&b->free[order]))
+      return (size_t) 1 << order;
+  return 0;
+}
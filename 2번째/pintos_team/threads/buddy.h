@@ -0,0 +1,44 @@
+#ifndef THREADS_BUDDY_H
+#define THREADS_BUDDY_H
+
+#include <list.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Binary buddy allocator for a range of pages.
+
+   Free memory is kept as blocks of 2**ORDER pages, each aligned
+   to its own size in physical memory, with one free list per
+   order.  An allocation of N pages takes a block of the smallest
+   order that fits, splitting a larger block in halves as needed,
+   and gives back the pages past N at once.  Freeing pages merges
+   each freed block with its buddy, the other half of the block
+   of the next order up, for as long as the buddy is free too.
+
+   The free lists are threaded through the free pages
+   themselves, so the only other space needed is one byte per
+   page, provided by the caller.  The allocator does no locking
+   of its own. */
+
+#define BUDDY_MAX_ORDER 20              /* Largest block, 4 GB. */
+#define BUDDY_ERROR SIZE_MAX
+
+/* A buddy allocator. */
+struct buddy
+  {
+    uint8_t *base;                      /* First page. */
+    size_t page_cnt;                    /* Number of pages. */
+    size_t base_pfn;                    /* Page number of BASE. */
+    uint8_t *order;                     /* Per page: see buddy.c. */
+    struct list free[BUDDY_MAX_ORDER + 1]; /* Free blocks by order. */
+    size_t free_cnt;                    /* Free pages. */
+  };
+
+size_t buddy_buf_size (size_t page_cnt);
+void buddy_init (struct buddy *, void *base, size_t page_cnt,
+                 void *buf, size_t buf_size);
+size_t buddy_alloc (struct buddy *, size_t page_cnt);
+void buddy_free (struct buddy *, size_t page_idx, size_t page_cnt);
+size_t buddy_largest_free (struct buddy *);
+
+#endif /* threads/buddy.h */
@@ -0,0 +1,422 @@
+#include "threads/extent.h"
+#include <debug.h>
+#include "threads/vaddr.h"
+
+/* A free extent, kept in its own first page.
+
+   Both trees are treaps: binary search trees that are also heaps
+   on PRIORITY, a hash of the address, which keeps them balanced
+   in expectation without any rebalancing bookkeeping. */
+struct extent
+  {
+    size_t len;                         /* Length in pages. */
+    unsigned priority;                  /* Heap order within the trees. */
+    struct extent *left, *right;        /* Children by address. */
+    size_t max_len;                     /* Longest extent in this subtree. */
+    struct extent *shorter, *longer;    /* Children by length. */
+  };
+
+/* Returns the extent whose first page is page START of IX. */
+static struct extent *
+extent_at (const struct extent_index *ix, size_t start)
+{
+  return (struct extent *) (ix->base + start * PGSIZE);
+}
+
+/* Returns the index of the first page of extent E in IX. */
+static size_t
+start_of (const struct extent_index *ix, const struct extent *e)
+{
+  return ((const uint8_t *) e - ix->base) / PGSIZE;
+}
+
+/* Recomputes E's MAX_LEN from its own length and its children's. */
+static void
+update (struct extent *e)
+{
+  e->max_len = e->len;
+  if (e->left != NULL && e->left->max_len > e->max_len)
+    e->max_len = e->left->max_len;
+  if (e->right != NULL && e->right->max_len > e->max_len)
+    e->max_len = e->right->max_len;
+}
+
+/* Splits tree T into the extents below address KEY, returned in
+   *LEFT, and the rest, returned in *RIGHT. */
+static void
+split (const struct extent_index *ix, struct extent *t, size_t key,
+       struct extent **left, struct extent **right)
+{
+  if (t == NULL)
+    *left = *right = NULL;
+  else if (start_of (ix, t) < key)
+    {
+      split (ix, t->right, key, &t->right, right);
+      update (t);
+      *left = t;
+    }
+  else
+    {
+      split (ix, t->left, key, left, &t->left);
+      update (t);
+      *right = t;
+    }
+}
+
+/* Joins trees A and B, where every extent in A is below every
+   extent in B, and returns the result. */
+static struct extent *
+join (struct extent *a, struct extent *b)
+{
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+  if (a->priority > b->priority)
+    {
+      a->right = join (a->right, b);
+      update (a);
+      return a;
+    }
+  else
+    {
+      b->left = join (a, b->left);
+      update (b);
+      return b;
+    }
+}
+
+/* Inserts E into tree T and returns the new tree. */
+static struct extent *
+tree_insert (const struct extent_index *ix, struct extent *t,
+             struct extent *e)
+{
+  if (t == NULL || e->priority > t->priority)
+    {
+      split (ix, t, start_of (ix, e), &e->left, &e->right);
+      update (e);
+      return e;
+    }
+  if (start_of (ix, e) < start_of (ix, t))
+    t->left = tree_insert (ix, t->left, e);
+  else
+    t->right = tree_insert (ix, t->right, e);
+  update (t);
+  return t;
+}
+
+/* Removes E from tree T and returns the new tree. */
+static struct extent *
+tree_remove (const struct extent_index *ix, struct extent *t,
+             struct extent *e)
+{
+  ASSERT (t != NULL);
+
+  if (t == e)
+    return join (e->left, e->right);
+  if (start_of (ix, e) < start_of (ix, t))
+    t->left = tree_remove (ix, t->left, e);
+  else
+    t->right = tree_remove (ix, t->right, e);
+  update (t);
+  return t;
+}
+
+/* Returns the lowest extent in tree T at least CNT pages long,
+   or a null pointer if there is none. */
+static struct extent *
+tree_first_fit (struct extent *t, size_t cnt)
+{
+  while (t != NULL && t->max_len >= cnt)
+    {
+      if (t->left != NULL && t->left->max_len >= cnt)
+        t = t->left;
+      else if (t->len >= cnt)
+        return t;
+      else
+        t = t->right;
+    }
+  return NULL;
+}
+
+/* Returns the lowest extent in tree T that starts at or after
+   page CURSOR and is at least CNT pages long, or a null pointer
+   if there is none. */
+static struct extent *
+tree_fit_from (const struct extent_index *ix, struct extent *t,
+               size_t cursor, size_t cnt)
+{
+  struct extent *e;
+
+  if (t == NULL || t->max_len < cnt)
+    return NULL;
+  if (start_of (ix, t) < cursor)
+    return tree_fit_from (ix, t->right, cursor, cnt);
+  e = tree_fit_from (ix, t->left, cursor, cnt);
+  if (e != NULL)
+    return e;
+  if (t->len >= cnt)
+    return t;
+  return tree_first_fit (t->right, cnt);
+}
+
+/* Returns the extent in tree T that ends just before page START,
+   or a null pointer if there is none. */
+static struct extent *
+tree_ending_at (const struct extent_index *ix, struct extent *t,
+                size_t start)
+{
+  struct extent *below = NULL;
+
+  /* Find the last extent that starts before START. */
+  while (t != NULL)
+    if (start_of (ix, t) < start)
+      {
+        below = t;
+        t = t->right;
+      }
+    else
+      t = t->left;
+  return (below != NULL && start_of (ix, below) + below->len == start
+          ? below : NULL);
+}
+
+/* Returns the extent in tree T that starts at page START, or a
+   null pointer if there is none. */
+static struct extent *
+tree_starting_at (const struct extent_index *ix, struct extent *t,
+                  size_t start)
+{
+  while (t != NULL && start_of (ix, t) != start)
+    t = start < start_of (ix, t) ? t->left : t->right;
+  return t;
+}
+
+/* Returns true if extent A comes before extent B in the tree
+   ordered by length: if it is shorter, or as long and lower. */
+static bool
+len_less (const struct extent_index *ix, const struct extent *a,
+          const struct extent *b)
+{
+  if (a->len != b->len)
+    return a->len < b->len;
+  return start_of (ix, a) < start_of (ix, b);
+}
+
+/* Splits length tree T into the extents that come before E,
+   returned in *SHORTER, and the rest, returned in *LONGER. */
+static void
+len_split (const struct extent_index *ix, struct extent *t,
+           const struct extent *e,
+           struct extent **shorter, struct extent **longer)
+{
+  if (t == NULL)
+    *shorter = *longer = NULL;
+  else if (len_less (ix, t, e))
+    {
+      len_split (ix, t->longer, e, &t->longer, longer);
+      *shorter = t;
+    }
+  else
+    {
+      len_split (ix, t->shorter, e, shorter, &t->shorter);
+      *longer = t;
+    }
+}
+
+/* Joins length trees A and B, where every extent in A comes
+   before every extent in B, and returns the result. */
+static struct extent *
+len_join (struct extent *a, struct extent *b)
+{
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+  if (a->priority > b->priority)
+    {
+      a->longer = len_join (a->longer, b);
+      return a;
+    }
+  else
+    {
+      b->shorter = len_join (a, b->shorter);
+      return b;
+    }
+}
+
+/* Inserts E into length tree T and returns the new tree. */
+static struct extent *
+len_insert (const struct extent_index *ix, struct extent *t,
+            struct extent *e)
+{
+  if (t == NULL || e->priority > t->priority)
+    {
+      len_split (ix, t, e, &e->shorter, &e->longer);
+      return e;
+    }
+  if (len_less (ix, e, t))
+    t->shorter = len_insert (ix, t->shorter, e);
+  else
+    t->longer = len_insert (ix, t->longer, e);
+  return t;
+}
+
+/* Removes E from length tree T and returns the new tree. */
+static struct extent *
+len_remove (const struct extent_index *ix, struct extent *t,
+            struct extent *e)
+{
+  ASSERT (t != NULL);
+
+  if (t == e)
+    return len_join (e->shorter, e->longer);
+  if (len_less (ix, e, t))
+    t->shorter = len_remove (ix, t->shorter, e);
+  else
+    t->longer = len_remove (ix, t->longer, e);
+  return t;
+}
+
+/* Returns the shortest extent in length tree T at least CNT
+   pages long, the lowest of them if there are several, or a null
+   pointer if there is none. */
+static struct extent *
+len_best_fit (struct extent *t, size_t cnt)
+{
+  struct extent *best = NULL;
+
+  while (t != NULL)
+    if (t->len >= cnt)
+      {
+        best = t;
+        t = t->shorter;
+      }
+    else
+      t = t->longer;
+  return best;
+}
+
+/* Adds a free extent of LEN pages at START to IX. */
+static void
+add_extent (struct extent_index *ix, size_t start, size_t len)
+{
+  struct extent *e = extent_at (ix, start);
+
+  e->len = len;
+  e->priority = (unsigned) start * 2654435761u;
+  e->left = e->right = NULL;
+  ix->root = tree_insert (ix, ix->root, e);
+  ix->by_len = len_insert (ix, ix->by_len, e);
+}
+
+/* Removes free extent E from IX. */
+static void
+remove_extent (struct extent_index *ix, struct extent *e)
+{
+  ix->root = tree_remove (ix, ix->root, e);
+  ix->by_len = len_remove (ix, ix->by_len, e);
+}
+
+/* Initializes IX to index the PAGE_CNT pages starting at BASE,
+   all free. */
+void
+extent_init (struct extent_index *ix, void *base, size_t page_cnt)
+{
+  ASSERT (ix != NULL);
+  ASSERT (pg_ofs (base) == 0);
+
+  ix->base = base;
+  ix->page_cnt = page_cnt;
+  ix->root = NULL;
+  ix->by_len = NULL;
+  ix->free_cnt = 0;
+  if (page_cnt > 0)
+    extent_give (ix, 0, page_cnt);
+}
+
+/* Returns the first page of the lowest extent in IX at least
+   CNT pages long, or EXTENT_ERROR if there is none. */
+size_t
+extent_first_fit (struct extent_index *ix, size_t cnt)
+{
+  struct extent *e = tree_first_fit (ix->root, cnt);
+
+  return e != NULL ? start_of (ix, e) : EXTENT_ERROR;
+}
+
+/* Returns the first page of the lowest extent in IX at least
+   CNT pages long that starts at or after page CURSOR, or, if
+   there is none, of the lowest one anywhere, or EXTENT_ERROR if
+   there is none at all. */
+size_t
+extent_next_fit (struct extent_index *ix, size_t cursor, size_t cnt)
+{
+  struct extent *e = tree_fit_from (ix, ix->root, cursor, cnt);
+
+  if (e == NULL)
+    e = tree_first_fit (ix->root, cnt);
+  return e != NULL ? start_of (ix, e) : EXTENT_ERROR;
+}
+
+/* Returns the first page of the shortest extent in IX at least
+   CNT pages long, the lowest of them if there are several, or
+   EXTENT_ERROR if there is none. */
+size_t
+extent_best_fit (struct extent_index *ix, size_t cnt)
+{
+  struct extent *e = len_best_fit (ix->by_len, cnt);
+
+  return e != NULL ? start_of (ix, e) : EXTENT_ERROR;
+}
+
+/* Marks the CNT pages at the start of the free extent that
+   begins at page START in IX as used. */
+void
+extent_take (struct extent_index *ix, size_t start, size_t cnt)
+{
+  struct extent *e = extent_at (ix, start);
+  size_t len = e->len;
+
+  ASSERT (cnt > 0 && cnt <= len);
+
+  remove_extent (ix, e);
+  if (cnt < len)
+    add_extent (ix, start + cnt, len - cnt);
+  ix->free_cnt -= cnt;
+}
+
+/* Marks the CNT pages starting at page START in IX, all in use,
+   as free, merging them with the free extents on either side. */
+void
+extent_give (struct extent_index *ix, size_t start, size_t cnt)
+{
+  struct extent *before, *after;
+  size_t end = start + cnt;
+
+  ASSERT (cnt > 0);
+  ASSERT (end <= ix->page_cnt);
+
+  ix->free_cnt += cnt;
+  after = tree_starting_at (ix, ix->root, end);
+  if (after != NULL)
+    {
+      cnt += after->len;
+      remove_extent (ix, after);
+    }
+  before = tree_ending_at (ix, ix->root, start);
+  if (before != NULL)
+    {
+      start = start_of (ix, before);
+      cnt += before->len;
+      remove_extent (ix, before);
+    }
+  add_extent (ix, start, cnt);
+}
+
+/* Returns the length of the longest extent in IX. */
+size_t
+extent_largest (const struct extent_index *ix)
+{
+  return ix->root != NULL ? ix->root->max_len : 0;
+}
@@ -0,0 +1,42 @@
+#ifndef THREADS_EXTENT_H
+#define THREADS_EXTENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Index of the free extents of a range of pages.
+
+   An extent is a maximal run of free pages.  Each one is kept
+   in two trees.  The first is ordered by address, and every node
+   also knows the longest extent below it, so that it answers
+   "the lowest extent at or after some page that is at least N
+   pages long" in O(log n), which gives first fit and next fit.
+   The second is ordered by length, then address, and gives best
+   fit, also in O(log n).
+
+   The index lives in the free pages themselves: each extent's
+   first page holds its node.  It does no locking of its own. */
+
+#define EXTENT_ERROR SIZE_MAX
+
+struct extent;
+
+/* A free extent index. */
+struct extent_index
+  {
+    uint8_t *base;                      /* First page. */
+    size_t page_cnt;                    /* Number of pages. */
+    struct extent *root;                /* Tree ordered by address. */
+    struct extent *by_len;              /* Tree ordered by length. */
+    size_t free_cnt;                    /* Free pages. */
+  };
+
+void extent_init (struct extent_index *, void *base, size_t page_cnt);
+size_t extent_first_fit (struct extent_index *, size_t cnt);
+size_t extent_next_fit (struct extent_index *, size_t cursor, size_t cnt);
+size_t extent_best_fit (struct extent_index *, size_t cnt);
+void extent_take (struct extent_index *, size_t start, size_t cnt);
+void extent_give (struct extent_index *, size_t start, size_t cnt);
+size_t extent_largest (const struct extent_index *);
+
+#endif /* threads/extent.h */
@@ -0,0 +1,313 @@
+#include "threads/group.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* The root group, to which all threads belong at first. */
+struct thread_group group_root;
+
+/* All groups other than the root, in creation order, so that
+   every group comes after its parent. */
+static struct thread_group groups[GROUP_MAX - 1];
+static int group_cnt;
+
+/* End of the current period. */
+static int64_t period_end;
+
+static void divide_share (struct thread_group *parent, const bool active[]);
+static void release_parked (struct thread_group *, struct list *released);
+
+/* Returns group number I, counting the root as 0. */
+static struct thread_group *
+group_at (int i)
+{
+  return i == 0 ? &group_root : &groups[i - 1];
+}
+
+/* Initializes a group G named NAME under PARENT. */
+static void
+init_group (struct thread_group *g, const char *name,
+            struct thread_group *parent, int weight, int quota)
+{
+  memset (g, 0, sizeof *g);
+  strlcpy (g->name, name, sizeof g->name);
+  g->parent = parent;
+  g->weight = weight;
+  g->quota = quota;
+  g->throttle = GROUP_RUNNING;
+  list_init (&g->parked);
+}
+
+/* Sets up the root group.  Called by thread_init() before the
+   first thread is initialized. */
+void
+group_init (void)
+{
+  init_group (&group_root, "root", NULL, GROUP_WEIGHT_DEFAULT, 0);
+  group_cnt = 0;
+  period_end = GROUP_PERIOD;
+}
+
+/* Creates a group named NAME under PARENT, or under the root if
+   PARENT is null, with the given WEIGHT, which must be positive,
+   and QUOTA, in ticks per GROUP_PERIOD, or 0 for no quota.
+   Returns the new group, or a null pointer if GROUP_MAX groups
+   already exist.  Groups are never destroyed. */
+struct thread_group *
+group_create (const char *name, struct thread_group *parent,
+              int weight, int quota)
+{
+  struct thread_group *g = NULL;
+  enum intr_level old_level;
+
+  ASSERT (name != NULL);
+  ASSERT (weight > 0);
+  ASSERT (quota >= 0 && quota <= GROUP_PERIOD);
+
+  old_level = intr_disable ();
+  if (group_cnt < GROUP_MAX - 1)
+    {
+      g = &groups[group_cnt++];
+      init_group (g, name, parent != NULL ? parent : &group_root,
+                  weight, quota);
+    }
+  intr_set_level (old_level);
+  return g;
+}
+
+/* Charges one tick to G and its ancestors, throttling any that
+   go over their quota or share.  Returns true if G is now
+   throttled.  Interrupts must be off. */
+bool
+group_charge (struct thread_group *g)
+{
+  struct thread_group *a;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (a = g; a != NULL; a = a->parent)
+    {
+      a->usage++;
+      a->total_ticks++;
+      if (a == &group_root || a->throttle == GROUP_OVER_QUOTA)
+        continue;
+      if (a->quota > 0 && a->usage >= a->quota)
+        {
+          if (a->throttle == GROUP_RUNNING)
+            a->throttle_cnt++;
+          a->throttle = GROUP_OVER_QUOTA;
+        }
+      else if (a->share > 0 && !a->share_waived && a->usage >= a->share
+               && a->throttle == GROUP_RUNNING)
+        {
+          a->throttle_cnt++;
+          a->throttle = GROUP_OVER_SHARE;
+        }
+    }
+  return group_throttled (g);
+}
+
+/* Returns true if G or any of its ancestors is throttled. */
+bool
+group_throttled (const struct thread_group *g)
+{
+  for (; g != NULL; g = g->parent)
+    if (g->throttle != GROUP_RUNNING)
+      return true;
+  return false;
+}
+
+/* Parks T, which is not running, ready or blocked on anything,
+   because its group is throttled.  It stays parked until the
+   group is released.  Interrupts must be off. */
+void
+group_park (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  list_push_back (&t->group->parked, &t->elem);
+  t->group->park_cnt++;
+}
+
+/* Returns true if the current period has ended as of NOW. */
+bool
+group_period_due (int64_t now)
+{
+  return now >= period_end;
+}
+
+/* Starts a new period as of NOW: hands out shares for it,
+   releases every throttled group, and moves all parked threads
+   to RELEASED, for the caller to make ready.  Interrupts must
+   be off. */
+void
+group_new_period (int64_t now, struct list *released)
+{
+  bool active[GROUP_MAX];
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (period_end <= now)
+    period_end += GROUP_PERIOD;
+
+  /* A group wants the CPU if it ran last period or has threads
+     waiting for it now.  Parents come before their children, so
+     each parent's share is set before it is divided. */
+  for (i = 1; i <= group_cnt; i++)
+    {
+      struct thread_group *g = group_at (i);
+      active[i] = g->usage > 0 || !list_empty (&g->parked);
+    }
+  group_root.share = GROUP_PERIOD;
+  for (i = 0; i <= group_cnt; i++)
+    divide_share (group_at (i), active);
+
+  for (i = 0; i <= group_cnt; i++)
+    {
+      struct thread_group *g = group_at (i);
+
+      g->last_usage = g->usage;
+      g->usage = 0;
+      g->throttle = GROUP_RUNNING;
+      g->share_waived = false;
+      release_parked (g, released);
+    }
+}
+
+/* Divides PARENT's share among those of its children that are
+   ACTIVE, in proportion to their weights, except that a child
+   never gets more than its quota: what it cannot use goes to its
+   siblings instead.  Inactive children get no share, that is, no
+   limit, until the next period. */
+static void
+divide_share (struct thread_group *parent, const bool active[])
+{
+  bool capped[GROUP_MAX];
+  int left = parent->share, weight;
+  bool again;
+  int i;
+
+  for (i = 1; i <= group_cnt; i++)
+    {
+      capped[i] = false;
+      if (group_at (i)->parent == parent)
+        group_at (i)->share = 0;
+    }
+  if (left <= 0)
+    return;
+
+  do
+    {
+      weight = 0;
+      for (i = 1; i <= group_cnt; i++)
+        if (group_at (i)->parent == parent && active[i] && !capped[i])
+          weight += group_at (i)->weight;
+      if (weight == 0)
+        return;
+
+      /* Give capped children their quotas first, then divide
+         what is left among the rest. */
+      again = false;
+      for (i = 1; i <= group_cnt; i++)
+        {
+          struct thread_group *g = group_at (i);
+          if (g->parent == parent && active[i] && !capped[i]
+              && g->quota > 0 && g->quota < left * g->weight / weight)
+            {
+              g->share = g->quota;
+              capped[i] = true;
+              again = true;
+            }
+        }
+      if (again)
+        for (left = parent->share, i = 1; i <= group_cnt; i++)
+          if (capped[i] && group_at (i)->parent == parent)
+            left -= group_at (i)->share;
+    }
+  while (again);
+
+  for (i = 1; i <= group_cnt; i++)
+    {
+      struct thread_group *g = group_at (i);
+      if (g->parent == parent && active[i] && !capped[i])
+        {
+          g->share = left * g->weight / weight;
+          if (g->share < 1)
+            g->share = 1;
+        }
+    }
+}
+
+/* Lifts the throttle from every group that is only over its
+   share, for the rest of the period, and moves the parked
+   threads that are no longer throttled to RELEASED.  Called
+   when nothing else is ready to run.  Returns true if any thread
+   was released.  Interrupts must be off. */
+bool
+group_waive_shares (struct list *released)
+{
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (i = 1; i <= group_cnt; i++)
+    {
+      struct thread_group *g = group_at (i);
+
+      if (g->throttle == GROUP_OVER_SHARE)
+        {
+          g->throttle = GROUP_RUNNING;
+          g->share_waived = true;
+        }
+    }
+  for (i = 1; i <= group_cnt; i++)
+    if (!group_throttled (group_at (i)))
+      release_parked (group_at (i), released);
+  return !list_empty (released);
+}
+
+/* Moves G's parked threads to the end of RELEASED. */
+static void
+release_parked (struct thread_group *g, struct list *released)
+{
+  while (!list_empty (&g->parked))
+    list_push_back (released, list_pop_front (&g->parked));
+}
+
+/* Returns the tick at which throttled groups will next be
+   released, or INT64_MAX if none is throttled. */
+int64_t
+group_next_release (void)
+{
+  int i;
+
+  for (i = 1; i <= group_cnt; i++)
+    if (group_at (i)->throttle != GROUP_RUNNING)
+      return period_end;
+  return INT64_MAX;
+}
+
+/* Prints the CPU usage of each group, if any were created. */
+void
+group_print_stats (void)
+{
+  int i;
+
+  if (group_cnt == 0)
+    return;
+  for (i = 0; i <= group_cnt; i++)
+    {
+      struct thread_group *g = group_at (i);
+
+      printf ("Group: %-15s parent %-15s weight %4d quota %3d/%d: "
+              "%d threads, %lld ticks, %d last period, share %d, "
+              "%u throttles, %u parks\n",
+              g->name, g->parent != NULL ? g->parent->name : "-",
+              g->weight, g->quota, GROUP_PERIOD, g->thread_cnt,
+              g->total_ticks, g->last_usage, g->share,
+              g->throttle_cnt, g->park_cnt);
+    }
+}
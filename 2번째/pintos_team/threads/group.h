@@ -0,0 +1,87 @@
+#ifndef THREADS_GROUP_H
+#define THREADS_GROUP_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+
+/* CPU groups.
+
+   Every thread belongs to a group, and groups form a tree under
+   the root group.  A new thread joins its creator's group.  The
+   CPU is shared among groups, not among threads, so a group with
+   many threads does not crowd out a group with few.
+
+   Time is divided into periods of GROUP_PERIOD ticks.  At the
+   start of each period, every group that wants the CPU is
+   given a share of its parent's share, in proportion to its
+   weight among the siblings that also want it; the root's share
+   is the whole period.  Optionally, a group also has a hard
+   quota of ticks per period.
+
+   Every tick a thread runs is charged to its group and to each
+   of the group's ancestors.  A group that has used up its quota
+   is throttled until the next period.  One that has used up its
+   share is throttled as well, but only as long as some other
+   thread can use the CPU: if all that is left to run belongs to
+   groups over their share, they are released early.  A thread
+   whose group, or an ancestor of it, is throttled is parked
+   when it would be picked to run, and made ready again when the
+   group is released.
+
+   Threads in the root group itself, real-time threads and idle
+   threads are never throttled, though they are still charged. */
+
+#define GROUP_MAX 16                    /* Most groups, including root. */
+#define GROUP_PERIOD 100                /* Ticks per period. */
+#define GROUP_NAME_MAX 15               /* Longest group name. */
+#define GROUP_WEIGHT_DEFAULT 100        /* Default weight. */
+
+enum group_throttle
+  {
+    GROUP_RUNNING,                      /* Not throttled. */
+    GROUP_OVER_SHARE,                   /* Used up its share. */
+    GROUP_OVER_QUOTA                    /* Used up its quota. */
+  };
+
+/* A group of threads. */
+struct thread_group
+  {
+    char name[GROUP_NAME_MAX + 1];      /* Name, for statistics. */
+    struct thread_group *parent;        /* Null for the root. */
+    int weight;                         /* Relative claim on the CPU. */
+    int quota;                          /* Max ticks per period, 0 if none. */
+
+    /* Current period. */
+    int share;                          /* Ticks owed, 0 if unlimited. */
+    int usage;                          /* Ticks used. */
+    enum group_throttle throttle;       /* Whether throttled, and why. */
+    bool share_waived;                  /* Released early this period. */
+    struct list parked;                 /* Threads parked while throttled. */
+
+    /* Statistics. */
+    int thread_cnt;                     /* Member threads. */
+    int64_t total_ticks;                /* Ticks used, all periods. */
+    int last_usage;                     /* Ticks used last period. */
+    unsigned throttle_cnt;              /* Times throttled. */
+    unsigned park_cnt;                  /* Threads parked. */
+  };
+
+extern struct thread_group group_root;
+
+void group_init (void);
+struct thread_group *group_create (const char *name,
+                                   struct thread_group *parent,
+                                   int weight, int quota);
+bool group_charge (struct thread_group *);
+bool group_throttled (const struct thread_group *);
+void group_park (struct thread *);
+bool group_period_due (int64_t now);
+void group_new_period (int64_t now, struct list *released);
+bool group_waive_shares (struct list *released);
+int64_t group_next_release (void);
+void group_print_stats (void);
+
+#endif /* threads/group.h */
@@ -21,6 +21,9 @@
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/schedtrace.h"
+#include "threads/softirq.h"
+#include "threads/synch.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -35,8 +38,19 @@
 #include "projects/crossroads/crossroads.h"
 /* project #2 problem #1 */
 #include "projects/scheduling/schedulingtest.h"
+#include "projects/scheduling/interactivitytest.h"
+#include "projects/scheduling/schedbench.h"
+#include "projects/scheduling/grouptest.h"
 /* project #2 problem #2 */
 #include "projects/memalloc/memalloctest.h"
+#include "projects/memalloc/pallocbench.h"
+#include "projects/memalloc/bitmapbench.h"
+/* thread creation benchmark */
+#include "projects/threadbench/threadbench.h"
+/* lock benchmark */
+#include "projects/lockbench/lockbench.h"
+#include "projects/lockbench/rwlockbench.h"
+#include "projects/lockbench/synchtest.h"
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
@@ -99,7 +113,8 @@ int main (void)
 	/* Greet user. */
 	printf ("Pintos booting with %'"PRIu32" kB RAM...\n",
 	        init_ram_pages * PGSIZE / 1024);
-	printf ("Using page allocator %d\n", pallocator);
+	printf ("Using page allocator %d for kernel pages, %d for user pages\n",
+	        pallocator, user_pallocator);
 
 	/* Initialize memory system. */
 	palloc_init (user_page_limit);
@@ -124,6 +139,7 @@ int main (void)
 
 	/* Start thread scheduler and enable interrupts. */
 	thread_start ();
+	softirq_start ();
 	serial_init_queue ();
 	timer_calibrate ();
 
@@ -256,8 +272,26 @@ static char **parse_options (char **argv)
 #endif
 		else if (!strcmp (name, "-rs"))
 			random_init (atoi (value));
-		else if (!strcmp (name, "-ma"))
+		else if (!strcmp (name, "-ma")) {
+			const char *user = strchr (value, ',');
+
 			pallocator = (enum palloc_allocator) atoi (value);
+			user_pallocator = (user != NULL
+					   ? (enum palloc_allocator) atoi (user + 1)
+					   : pallocator);
+		}
+		else if (!strcmp (name, "-trace"))
+			schedtrace_enabled = true;
+		else if (!strcmp (name, "-nohz"))
+			timer_tickless = true;
+		else if (!strcmp (name, "-sched"))
+			thread_sched_name = value;
+		else if (!strcmp (name, "-mlfqs"))
+			thread_sched_name = "mlfqs";
+		else if (!strcmp (name, "-mfq"))
+			thread_mfq_levels = atoi (value);
+		else if (!strcmp (name, "-slices"))
+			thread_mfq_slices = value;
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
@@ -294,6 +328,20 @@ run_task (char **argv)
 	printf ("Execution of '%s' complete.\n", task);
 }
 
+/* Prints scheduling statistics gathered so far. */
+static void
+run_schedstat (char **argv UNUSED)
+{
+	thread_print_schedstat ();
+}
+
+/* Prints the most contended locks. */
+static void
+run_lockstat (char **argv UNUSED)
+{
+	lock_print_stats ();
+}
+
 /* Executes all of the actions specified in ARGV[]
    up to the null pointer sentinel. */
 static void
@@ -312,7 +360,18 @@ run_actions (char **argv)
 		{"messagepassing", 1, run_message_passing_test},
 		{"crossroads", 2, run_crossroads},
 		{"scheduling", 1, run_scheduling_test},
+		{"interactivity", 1, run_interactivity_test},
+		{"schedbench", 2, run_schedbench},
+		{"groups", 1, run_group_test},
 		{"memalloc", 1, run_memalloc_test},
+		{"pallocbench", 1, run_pallocbench},
+		{"bitmapbench", 1, run_bitmapbench},
+		{"threadbench", 1, run_threadbench},
+		{"lockbench", 1, run_lockbench},
+		{"rwlockbench", 1, run_rwlockbench},
+		{"synchtest", 1, run_synchtest},
+		{"schedstat", 1, run_schedstat},
+		{"lockstat", 1, run_lockstat},
 #ifdef FILESYS
 		{"ls", 1, fsutil_ls},
 		{"cat", 2, fsutil_cat},
@@ -360,6 +419,10 @@ usage (void)
 #else
 	        "  run PROJECT           Run PROJECT.\n"
 #endif
+	        "  schedbench SPEC    Benchmark the scheduler; SPEC is \"-\" or\n"
+	        "                     threads=N,io=PCT,levels=N,secs=N.\n"
+	        "  schedstat          Print per-thread scheduling statistics.\n"
+	        "  lockstat           Print the most contended locks.\n"
 #ifdef FILESYS
 	        "  ls                 List files in the root directory.\n"
 	        "  cat FILE           Print FILE to the console.\n"
@@ -381,7 +444,16 @@ usage (void)
 #endif
 #endif
 	        "  -rs=SEED           Set random number seed to SEED.\n"
-	        "  -ma=NUM            Use specified memory allocator FF:0 NF:1\n"
+	        "  -ma=K[,U]          Use memory allocator K for kernel pages and U\n"
+	        "                     (default K) for user pages, each one of\n"
+	        "                     FF:0 NF:1 BF:2 BUDDY:3.\n"
+	        "  -mfq=LEVELS        Use LEVELS feedback queues (default 5).\n"
+	        "  -slices=S0,S1,...  Time slice in ticks of each queue, lowest first.\n"
+	        "  -sched=NAME        Use scheduler NAME: mfq (default), mlfqs,\n"
+	        "                     stride or lottery.\n"
+	        "  -mlfqs             Same as -sched=mlfqs.\n"
+	        "  -nohz              Stop the periodic timer tick while idle.\n"
+	        "  -trace             Trace context switches, dump at power off.\n"
 #ifdef USERPROG
 	        "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
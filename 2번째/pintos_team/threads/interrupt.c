@@ -6,7 +6,9 @@
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
+#include "threads/softirq.h"
 #include "threads/thread.h"
+#include "threads/tsc.h"
 #include "threads/vaddr.h"
 #include "devices/timer.h"
 
@@ -47,6 +49,19 @@ static unsigned int unexpected_cnt[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* True while running deferred work on exit from an external
+   interrupt (see softirq.h).  Interrupts are on then, so another
+   external interrupt may arrive; it leaves its own deferred work
+   and any yield to the exit already in progress. */
+static bool in_softirq;
+
+/* Time spent in external interrupt handlers, with interrupts
+   off, and in the deferred work run on their exit. */
+static long long hardirq_cnt;           /* External interrupts. */
+static uint64_t hardirq_cycles;         /* Total cycles, interrupts off. */
+static uint64_t hardirq_max_cycles;     /* Longest, interrupts off. */
+static uint64_t softirq_cycles;         /* Total cycles of deferred work. */
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -133,6 +148,8 @@ intr_init (void)
   idtr_operand = make_idtr_operand (sizeof idt - 1, idt);
   asm volatile ("lidt %0" : : "m" (idtr_operand));
 
+  softirq_init ();
+
   /* Initialize intr_names. */
   for (i = 0; i < INTR_CNT; i++)
     intr_names[i] = "unknown";
@@ -211,7 +228,7 @@ intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
 bool
 intr_context (void) 
 {
-  return in_external_intr;
+  return in_external_intr || in_softirq;
 }
 
 /* During processing of an external interrupt, directs the
@@ -346,6 +363,7 @@ intr_handler (struct intr_frame *frame)
 {
   bool external;
   intr_handler_func *handler;
+  uint64_t start = 0;
 
   /* External interrupts are special.
      We only handle one at a time (so interrupts must be off)
@@ -355,10 +373,12 @@ intr_handler (struct intr_frame *frame)
   if (external) 
     {
       ASSERT (intr_get_level () == INTR_OFF);
-      ASSERT (!intr_context ());
+      ASSERT (!in_external_intr);
 
+      start = tsc_read ();
       in_external_intr = true;
-      yield_on_return = false;
+      if (!in_softirq)
+        yield_on_return = false;
     }
 
   /* Invoke the interrupt's handler. */
@@ -383,11 +403,45 @@ intr_handler (struct intr_frame *frame)
       in_external_intr = false;
       pic_end_of_interrupt (frame->vec_no); 
 
-      if (yield_on_return) 
+      start = tsc_read () - start;
+      hardirq_cnt++;
+      hardirq_cycles += start;
+      if (start > hardirq_max_cycles)
+        hardirq_max_cycles = start;
+
+      /* Run deferred work, unless we interrupted that of an
+         outer interrupt, which will also see to our yield. */
+      if (in_softirq)
+        return;
+      if (softirq_pending ())
+        {
+          start = tsc_read ();
+          in_softirq = true;
+          softirq_run ();
+          in_softirq = false;
+          softirq_cycles += tsc_read () - start;
+        }
+
+      /* Nor may softirqd be preempted in the middle of an item,
+         since no other item can run until it finishes.  It
+         yields once its batch is done instead. */
+      if (yield_on_return && !softirq_running ())
         thread_yield (); 
     }
 }
 
+/* Prints how long external interrupts kept interrupts off, and
+   how long their deferred work took. */
+void
+intr_print_stats (void)
+{
+  printf ("Interrupts: %lld external, interrupts off %llu cycles avg, "
+          "%llu max; deferred work %llu cycles total\n",
+          hardirq_cnt, hardirq_cnt > 0 ? hardirq_cycles / hardirq_cnt : 0,
+          hardirq_max_cycles, softirq_cycles);
+  softirq_print_stats ();
+}
+
 /* Handles an unexpected interrupt with interrupt frame F.  An
    unexpected interrupt is one that has no registered handler. */
 static void
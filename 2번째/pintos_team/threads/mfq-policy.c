@@ -0,0 +1,99 @@
+#include "threads/mfq-policy.h"
+#include <debug.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Initializes P for LEVELS levels, which must be between 1 and
+   RQ_LEVELS_MAX, with the default aging parameters.  Level L
+   gets the slice given for it in SLICES, a comma-separated list
+   of tick counts for levels 0, 1, and so on, if SLICES is
+   non-null and long enough; otherwise MFQ_MIN_SLICE plus one
+   tick for every level above it, so lower levels run less
+   often but for longer.  Returns -1 if successful, or the level
+   whose slice in SLICES is not positive. */
+int
+mfq_policy_init (struct mfq_policy *p, int levels, const char *slices)
+{
+  int level;
+
+  p->levels = levels;
+  p->aging_threshold = MFQ_AGING_THRESHOLD;
+  p->aging_batch = MFQ_AGING_BATCH;
+  for (level = 0; level < levels; level++)
+    {
+      int slice = MFQ_MIN_SLICE + (levels - 1 - level);
+      if (slices != NULL && *slices != '\0')
+        {
+          slice = atoi (slices);
+          slices = strchr (slices, ',');
+          slices = slices != NULL ? slices + 1 : "";
+          if (slice < 1)
+            return level;
+        }
+      p->slice[level] = slice;
+    }
+  return -1;
+}
+
+/* Returns the slice to give a thread at LEVEL that has already
+   used USED ticks of it: the rest of the slice, but at least
+   one tick. */
+unsigned
+mfq_slice_left (const struct mfq_policy *p, int level, unsigned used)
+{
+  return used < p->slice[level] ? p->slice[level] - used : 1;
+}
+
+/* Returns true if a thread at LEVEL that has used USED ticks of
+   its slice has used it up and so is due for demotion when it
+   next gives up the CPU. */
+bool
+mfq_slice_spent (const struct mfq_policy *p, int level, unsigned used)
+{
+  return used >= p->slice[level];
+}
+
+/* Returns the base level of a thread demoted from BASE. */
+int
+mfq_demoted_level (const struct mfq_policy *p UNUSED, int base)
+{
+  return base > 0 ? base - 1 : base;
+}
+
+/* Returns true if a thread at LEVEL, with base level BASE, that
+   is waking up after using USED ticks of its slice should be
+   raised one base level.  Only threads that used less than half
+   of their slice are.  They keep the ticks they used, so a
+   thread cannot earn boosts by sleeping just before its slice
+   would run out: it is demoted once those ticks add up to a
+   whole slice. */
+bool
+mfq_wants_boost (const struct mfq_policy *p, int level, int base,
+                 unsigned used)
+{
+  return used * 2 < p->slice[level] && base < p->levels - 1;
+}
+
+/* Returns true if a thread that became ready at READY_TICK has
+   waited long enough as of NOW to earn a promotion. */
+bool
+mfq_aging_due (const struct mfq_policy *p, int64_t ready_tick, int64_t now)
+{
+  return now - ready_tick >= p->aging_threshold;
+}
+
+/* Returns the number of levels that a thread with base level
+   BASE, which has been ready since READY_TICK, has earned by
+   aging as of NOW: one for every aging threshold it has waited,
+   but not past the top level. */
+int
+mfq_promotions_earned (const struct mfq_policy *p, int base,
+                       int64_t ready_tick, int64_t now)
+{
+  int64_t earned = (now - ready_tick) / p->aging_threshold;
+  int room = p->levels - 1 - base;
+
+  if (earned <= 0 || room <= 0)
+    return 0;
+  return earned < room ? earned : room;
+}
@@ -0,0 +1,47 @@
+#ifndef THREADS_MFQ_POLICY_H
+#define THREADS_MFQ_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/runqueue.h"
+
+/* Rules of the multilevel feedback queue scheduler.
+
+   These functions decide how long a thread at a given level may
+   run, when it moves up or down a level, and how far.  They do
+   not touch threads, queues, or the clock, and they need nothing
+   beyond the C library, debug.h and runqueue.h, so the same code
+   builds both into the kernel, where thread.c applies its
+   decisions to real threads, and into utils/mfqsim, which
+   applies them to simulated tasks driven by a simulated tick.
+
+   Levels run from 0, the lowest priority, to LEVELS - 1. */
+
+#define MFQ_LEVELS_DEFAULT 5    /* Default number of levels. */
+#define MFQ_MIN_SLICE 2         /* Default slice of the top level. */
+#define MFQ_AGING_THRESHOLD 20  /* Ready ticks that earn one promotion. */
+#define MFQ_AGING_BATCH 4       /* Max promotions per level per tick. */
+
+/* Tunable parameters. */
+struct mfq_policy
+  {
+    int levels;                         /* Number of levels. */
+    unsigned slice[RQ_LEVELS_MAX];      /* Time slice of each level. */
+    int aging_threshold;                /* Ready ticks per promotion. */
+    int aging_batch;                    /* Promotions per level per sweep. */
+  };
+
+int mfq_policy_init (struct mfq_policy *, int levels, const char *slices);
+
+unsigned mfq_slice_left (const struct mfq_policy *, int level,
+                         unsigned used);
+bool mfq_slice_spent (const struct mfq_policy *, int level, unsigned used);
+int mfq_demoted_level (const struct mfq_policy *, int base);
+bool mfq_wants_boost (const struct mfq_policy *, int level, int base,
+                      unsigned used);
+bool mfq_aging_due (const struct mfq_policy *, int64_t ready_tick,
+                    int64_t now);
+int mfq_promotions_earned (const struct mfq_policy *, int base,
+                           int64_t ready_tick, int64_t now);
+
+#endif /* threads/mfq-policy.h */
@@ -7,6 +7,9 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/buddy.h"
+#include "threads/extent.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -25,23 +28,89 @@
    half to the user pool.  That should be huge overkill for the
    kernel pool, but that's just fine for demonstration purposes. */
 
+struct pool;
+
+/* A page allocation policy.
+
+   Each pool has its own, which keeps the pool's free pages in a
+   structure of its choosing and decides which of them to hand
+   out.  The pool itself only keeps used_map up to date, for
+   palloc_get_status() and palloc_get_stats().  All functions but
+   buf_size are called with interrupts off; see take_pages(). */
+struct pool_policy
+  {
+    /* Returns the number of bytes of memory, beyond the struct
+       pool, that the policy needs for a pool of PAGE_CNT pages. */
+    size_t (*buf_size) (size_t page_cnt);
+
+    /* Sets up POOL's PAGE_CNT pages, all free, with the BUF_SIZE
+       bytes at BUF for the policy's own use. */
+    void (*init) (struct pool *, size_t page_cnt,
+                  void *buf, size_t buf_size);
+
+    /* Removes PAGE_CNT contiguous pages from POOL's free pages and
+       returns the index of the first, or BITMAP_ERROR if there
+       are not enough contiguous free pages. */
+    size_t (*take) (struct pool *, size_t page_cnt);
+
+    /* Returns the PAGE_CNT pages starting at PAGE_IDX, all in
+       use, to POOL's free pages. */
+    void (*give) (struct pool *, size_t page_idx, size_t page_cnt);
+  };
+
 /* A memory pool. */
 struct pool
   {
     struct lock lock;                   /* Mutual exclusion. */
     struct bitmap *used_map;            /* Bitmap of free pages. */
     uint8_t *base;                      /* Base of pool. */
+    const struct pool_policy *policy;   /* How to find free pages. */
+
+    /* Free pages, for finding them fast, owned by POLICY. */
+    struct buddy buddy;                 /* Buddy policy. */
+    struct extent_index extents;        /* Fit policies. */
+    size_t next_fit;                    /* Where next fit looks first. */
   };
 
 /* Two pools: one for kernel data, one for user pages. */
 static struct pool kernel_pool, user_pool;
 
+static const struct pool_policy first_fit_policy, next_fit_policy;
+static const struct pool_policy best_fit_policy, buddy_policy;
+
+/* Policies, indexed by enum palloc_allocator. */
+static const struct pool_policy *const pool_policies[] =
+  {
+    [ALLOCATOR_FF] = &first_fit_policy,
+    [ALLOCATOR_NF] = &next_fit_policy,
+    [ALLOCATOR_BF] = &best_fit_policy,
+    [ALLOCATOR_BUDDY] = &buddy_policy,
+  };
+
 static void init_pool (struct pool *, void *base, size_t page_cnt,
-                       const char *name);
+                       const char *name,
+                       const struct pool_policy *policy);
 static bool page_from_pool (const struct pool *, void *page);
+static size_t take_pages (struct pool *, size_t page_cnt);
+static void give_pages (struct pool *, size_t page_idx, size_t page_cnt);
 
-/* The page allocation algorithm */
+/* The page allocation policies of the kernel and user pools,
+   chosen with -ma=K,U on the kernel command line.  Other users
+   of bitmaps, such as the file system's free map, have their own
+   policies. */
 enum palloc_allocator pallocator = 0;
+enum palloc_allocator user_pallocator = 0;
+
+/* Returns the policy for ALLOCATOR, or panics if there is none.
+   POOL names the pool it was chosen for. */
+static const struct pool_policy *
+policy_of (enum palloc_allocator allocator, const char *pool)
+{
+  if ((unsigned) allocator > ALLOCATOR_BUDDY)
+    PANIC ("-ma: unknown page allocator %d for the %s pool",
+           (int) allocator, pool);
+  return pool_policies[allocator];
+}
 
 /* Initializes the page allocator.  At most USER_PAGE_LIMIT
    pages are put into the user pool. */
@@ -60,9 +129,10 @@ palloc_init (size_t user_page_limit)
   kernel_pages = free_pages - user_pages;
 
   /* Give half of memory to kernel, half to user. */
-  init_pool (&kernel_pool, free_start, kernel_pages, "kernel pool");
+  init_pool (&kernel_pool, free_start, kernel_pages, "kernel pool",
+             policy_of (pallocator, "kernel"));
   init_pool (&user_pool, free_start + kernel_pages * PGSIZE,
-             user_pages, "user pool");
+             user_pages, "user pool", policy_of (user_pallocator, "user"));
 }
 
 /* Obtains and returns a group of PAGE_CNT contiguous free pages.
@@ -82,7 +152,7 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
     return NULL;
 
   lock_acquire (&pool->lock);
-  page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+  page_idx = take_pages (pool, page_cnt);
   lock_release (&pool->lock);
 
   if (page_idx != BITMAP_ERROR)
@@ -143,12 +213,7 @@ palloc_free_multiple (void *pages, size_t page_cnt)
 
   ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
 
-  if(pallocator == 3){              // 메모리 해제를 할때 받아오는 index와 cnt를 buddy 시스템일 때 함수를 호출하여 영역 색칠을 초기화할 준비를 한다.
-    buddy_remove(page_idx,page_cnt);
-  }
-
-  
-  bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  give_pages (pool, page_idx, page_cnt);
 }
 
 /* Frees the page at PAGE. */
@@ -169,15 +234,45 @@ palloc_get_status (enum palloc_flags flags)
   lock_release (&pool->lock);
 }
 
+/* Fills in STATS for the user pool if PAL_USER is set in FLAGS,
+   otherwise for the kernel pool. */
+void
+palloc_get_stats (enum palloc_flags flags, struct palloc_stats *stats)
+{
+  struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+  size_t page_cnt = bitmap_size (pool->used_map);
+  size_t i, run = 0;
+
+  stats->page_cnt = page_cnt;
+  stats->free_cnt = 0;
+  stats->largest_free = 0;
+
+  lock_acquire (&pool->lock);
+  for (i = 0; i < page_cnt; i++)
+    if (!bitmap_test (pool->used_map, i))
+      {
+        stats->free_cnt++;
+        if (++run > stats->largest_free)
+          stats->largest_free = run;
+      }
+    else
+      run = 0;
+  lock_release (&pool->lock);
+}
+
 /* Initializes pool P as starting at START and ending at END,
-   naming it NAME for debugging purposes. */
+   naming it NAME for debugging purposes, and finding free pages
+   with POLICY. */
 static void
-init_pool (struct pool *p, void *base, size_t page_cnt, const char *name) 
+init_pool (struct pool *p, void *base, size_t page_cnt, const char *name,
+           const struct pool_policy *policy)
 {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
+  /* We'll put the pool's used_map at its base, followed by the
+     policy's metadata.  Calculate the space needed for both
      and subtract it from the pool's size. */
-  size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
+  size_t bm_size = bitmap_buf_size (page_cnt);
+  size_t policy_size = policy->buf_size (page_cnt);
+  size_t bm_pages = DIV_ROUND_UP (bm_size + policy_size, PGSIZE);
   if (bm_pages > page_cnt)
     PANIC ("Not enough memory in %s for bitmap.", name);
   page_cnt -= bm_pages;
@@ -185,9 +280,47 @@ init_pool (struct pool *p, void *base, size_t page_cnt, const char *name)
   printf ("%zu pages available in %s.\n", page_cnt, name);
 
   /* Initialize the pool. */
-  lock_init (&p->lock);
-  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
+  lock_init_named (&p->lock, name);
+  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_size);
   p->base = base + bm_pages * PGSIZE;
+  p->policy = policy;
+  policy->init (p, page_cnt, (uint8_t *) base + bm_size,
+                bm_pages * PGSIZE - bm_size);
+}
+
+/* Finds PAGE_CNT free pages in POOL with POOL's policy, marks
+   them used, and returns the index of the first, or BITMAP_ERROR
+   if there are not enough contiguous free pages.  The caller
+   must hold POOL's lock.
+
+   Dying threads' pages are freed with interrupts off, in the
+   middle of a thread switch, where taking POOL's lock could
+   sleep.  So give_pages() does not take it, and the free page
+   index and used_map are kept in step by turning interrupts off
+   instead. */
+static size_t
+take_pages (struct pool *pool, size_t page_cnt)
+{
+  enum intr_level old_level = intr_disable ();
+  size_t page_idx = pool->policy->take (pool, page_cnt);
+
+  if (page_idx != BITMAP_ERROR)
+    bitmap_set_multiple (pool->used_map, page_idx, page_cnt, true);
+  intr_set_level (old_level);
+
+  return page_idx;
+}
+
+/* Marks the PAGE_CNT pages starting at PAGE_IDX in POOL free.
+   See take_pages() about locking. */
+static void
+give_pages (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  enum intr_level old_level = intr_disable ();
+
+  pool->policy->give (pool, page_idx, page_cnt);
+  bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  intr_set_level (old_level);
 }
 
 /* Returns true if PAGE was allocated from POOL,
@@ -201,3 +334,122 @@ page_from_pool (const struct pool *pool, void *page)
 
   return page_no >= start_page && page_no < end_page;
 }
+
+/* Buddy policy: see buddy.h. */
+
+static size_t
+buddy_policy_buf_size (size_t page_cnt)
+{
+  return buddy_buf_size (page_cnt);
+}
+
+static void
+buddy_policy_init (struct pool *pool, size_t page_cnt,
+                   void *buf, size_t buf_size)
+{
+  buddy_init (&pool->buddy, pool->base, page_cnt, buf, buf_size);
+}
+
+static size_t
+buddy_policy_take (struct pool *pool, size_t page_cnt)
+{
+  size_t page_idx = buddy_alloc (&pool->buddy, page_cnt);
+
+  return page_idx != BUDDY_ERROR ? page_idx : BITMAP_ERROR;
+}
+
+static void
+buddy_policy_give (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  buddy_free (&pool->buddy, page_idx, page_cnt);
+}
+
+static const struct pool_policy buddy_policy =
+  {
+    buddy_policy_buf_size,
+    buddy_policy_init,
+    buddy_policy_take,
+    buddy_policy_give,
+  };
+
+/* First, next and best fit policies, which differ only in which
+   free extent they pick: see extent.h. */
+
+static size_t
+fit_buf_size (size_t page_cnt UNUSED)
+{
+  return 0;
+}
+
+static void
+fit_init (struct pool *pool, size_t page_cnt,
+          void *buf UNUSED, size_t buf_size UNUSED)
+{
+  extent_init (&pool->extents, pool->base, page_cnt);
+  pool->next_fit = 0;
+}
+
+/* Takes PAGE_CNT pages from the start of the free extent at
+   PAGE_IDX in POOL, if PAGE_IDX is not EXTENT_ERROR, and returns
+   PAGE_IDX, or BITMAP_ERROR if it is. */
+static size_t
+fit_take (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  if (page_idx == EXTENT_ERROR)
+    return BITMAP_ERROR;
+  extent_take (&pool->extents, page_idx, page_cnt);
+  pool->next_fit = page_idx + page_cnt;
+  return page_idx;
+}
+
+static size_t
+first_fit_take (struct pool *pool, size_t page_cnt)
+{
+  return fit_take (pool, extent_first_fit (&pool->extents, page_cnt),
+                   page_cnt);
+}
+
+static size_t
+next_fit_take (struct pool *pool, size_t page_cnt)
+{
+  return fit_take (pool, extent_next_fit (&pool->extents, pool->next_fit,
+                                          page_cnt),
+                   page_cnt);
+}
+
+static size_t
+best_fit_take (struct pool *pool, size_t page_cnt)
+{
+  return fit_take (pool, extent_best_fit (&pool->extents, page_cnt),
+                   page_cnt);
+}
+
+static void
+fit_give (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  extent_give (&pool->extents, page_idx, page_cnt);
+}
+
+static const struct pool_policy first_fit_policy =
+  {
+    fit_buf_size,
+    fit_init,
+    first_fit_take,
+    fit_give,
+  };
+
+static const struct pool_policy next_fit_policy =
+  {
+    fit_buf_size,
+    fit_init,
+    next_fit_take,
+    fit_give,
+  };
+
+static const struct pool_policy best_fit_policy =
+  {
+    fit_buf_size,
+    fit_init,
+    best_fit_take,
+    fit_give,
+  };
@@ -21,6 +21,15 @@ enum palloc_allocator
   };
 
 extern enum palloc_allocator pallocator;
+extern enum palloc_allocator user_pallocator;
+
+/* Occupancy of a page pool. */
+struct palloc_stats
+  {
+    size_t page_cnt;            /* Pages in the pool. */
+    size_t free_cnt;            /* Free pages. */
+    size_t largest_free;        /* Longest run of free pages. */
+  };
 
 void palloc_init (size_t user_page_limit);
 void *palloc_get_page (enum palloc_flags);
@@ -28,5 +37,6 @@ void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
 void palloc_get_status (enum palloc_flags flags);
+void palloc_get_stats (enum palloc_flags flags, struct palloc_stats *);
 
 #endif /* threads/palloc.h */
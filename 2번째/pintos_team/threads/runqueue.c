@@ -0,0 +1,101 @@
+#include "threads/runqueue.h"
+#include <debug.h>
+
+/* Marks LEVEL of RQ as non-empty. */
+static inline void
+map_set (struct runqueue *rq, int level)
+{
+  rq->map[level / 32] |= (uint32_t) 1 << (level % 32);
+}
+
+/* Marks LEVEL of RQ as empty. */
+static inline void
+map_clear (struct runqueue *rq, int level)
+{
+  rq->map[level / 32] &= ~((uint32_t) 1 << (level % 32));
+}
+
+/* Initializes RQ as an empty run queue. */
+void
+rq_init (struct runqueue *rq)
+{
+  int i;
+
+  ASSERT (rq != NULL);
+
+  for (i = 0; i < RQ_MAP_WORDS; i++)
+    rq->map[i] = 0;
+  for (i = 0; i < RQ_LEVELS_MAX; i++)
+    list_init (&rq->levels[i]);
+  rq->cnt = 0;
+}
+
+/* Appends ELEM to the tail of LEVEL in RQ. */
+void
+rq_push_back (struct runqueue *rq, struct list_elem *elem, int level)
+{
+  ASSERT (level >= 0 && level < RQ_LEVELS_MAX);
+
+  list_push_back (&rq->levels[level], elem);
+  map_set (rq, level);
+  rq->cnt++;
+}
+
+/* Removes ELEM, which must currently be queued at LEVEL, from
+   RQ. */
+void
+rq_remove (struct runqueue *rq, struct list_elem *elem, int level)
+{
+  ASSERT (level >= 0 && level < RQ_LEVELS_MAX);
+  ASSERT (rq->cnt > 0);
+
+  list_remove (elem);
+  if (list_empty (&rq->levels[level]))
+    map_clear (rq, level);
+  rq->cnt--;
+}
+
+/* Returns the highest non-empty level in RQ, or -1 if RQ is
+   empty.  Runs in time proportional to the number of bitmap
+   words, not the number of levels. */
+int
+rq_highest (const struct runqueue *rq)
+{
+  int i;
+
+  for (i = RQ_MAP_WORDS - 1; i >= 0; i--)
+    if (rq->map[i] != 0)
+      return i * 32 + (31 - __builtin_clz (rq->map[i]));
+  return -1;
+}
+
+/* Removes and returns the element at the head of the highest
+   non-empty level of RQ, storing that level into *LEVEL if
+   LEVEL is non-null.  Returns a null pointer if RQ is empty. */
+struct list_elem *
+rq_pop_highest (struct runqueue *rq, int *level)
+{
+  int top = rq_highest (rq);
+  struct list_elem *e;
+
+  if (top < 0)
+    return NULL;
+
+  e = list_pop_front (&rq->levels[top]);
+  if (list_empty (&rq->levels[top]))
+    map_clear (rq, top);
+  rq->cnt--;
+
+  if (level != NULL)
+    *level = top;
+  return e;
+}
+
+/* Returns the list backing LEVEL of RQ, for read-only
+   iteration. */
+struct list *
+rq_level (struct runqueue *rq, int level)
+{
+  ASSERT (level >= 0 && level < RQ_LEVELS_MAX);
+  return &rq->levels[level];
+}
@@ -0,0 +1,42 @@
+#ifndef THREADS_RUNQUEUE_H
+#define THREADS_RUNQUEUE_H
+
+#include <list.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest number of priority levels a run queue can hold. */
+#define RQ_LEVELS_MAX 64
+
+/* Number of 32-bit words in the occupancy bitmap. */
+#define RQ_MAP_WORDS (RQ_LEVELS_MAX / 32)
+
+/* A multilevel run queue.
+
+   Each priority level has its own FIFO list.  Bit L of `map' is
+   set if and only if level L's list is non-empty, so the highest
+   non-empty level can be found with a couple of find-last-set
+   instructions, independent of the number of levels or of the
+   number of queued elements. */
+struct runqueue
+  {
+    uint32_t map[RQ_MAP_WORDS];         /* Non-empty level bitmap. */
+    struct list levels[RQ_LEVELS_MAX];  /* One FIFO per level. */
+    size_t cnt;                         /* Total queued elements. */
+  };
+
+void rq_init (struct runqueue *);
+void rq_push_back (struct runqueue *, struct list_elem *, int level);
+void rq_remove (struct runqueue *, struct list_elem *, int level);
+struct list_elem *rq_pop_highest (struct runqueue *, int *level);
+int rq_highest (const struct runqueue *);
+struct list *rq_level (struct runqueue *, int level);
+
+/* Returns the number of elements in RQ. */
+static inline size_t
+rq_size (const struct runqueue *rq)
+{
+  return rq->cnt;
+}
+
+#endif /* threads/runqueue.h */
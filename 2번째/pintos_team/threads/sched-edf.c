@@ -0,0 +1,167 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <limits.h>
+#include <list.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Earliest-deadline-first scheduling of periodic real-time
+   threads.
+
+   A periodic thread (see thread_create_periodic()) releases a job
+   every `period' ticks, which must finish by the start of the
+   next period, and may use at most `budget' ticks of CPU time in
+   each period.  Ready real-time threads always run ahead of the
+   threads of the ordinary scheduling class, and among themselves
+   the one with the earliest deadline runs first.
+
+   On a single CPU, EDF meets every deadline as long as the sum
+   of budget/period over all real-time threads is at most 1.
+   edf_admit() enforces a somewhat lower limit, EDF_UTIL_LIMIT,
+   so that ordinary threads are not starved outright, and budget
+   enforcement in edf_tick() keeps one thread's overrun from
+   spilling into the others' deadlines. */
+
+/* Utilization is kept in units of 1/EDF_UTIL_ONE. */
+#define EDF_UTIL_ONE 10000
+#define EDF_UTIL_LIMIT (EDF_UTIL_ONE * 9 / 10)
+
+/* Ready real-time threads, in order of increasing deadline. */
+static struct list ready_list;
+
+/* Utilization reserved by admitted threads. */
+static int total_util;
+
+/* Returns the utilization of a thread with PERIOD and BUDGET. */
+static int
+utilization (int period, int budget)
+{
+  return (int64_t) budget * EDF_UTIL_ONE / period;
+}
+
+/* Reserves CPU time for a thread that needs BUDGET ticks out of
+   every PERIOD.  Returns false, reserving nothing, if that would
+   overcommit the CPU. */
+bool
+edf_admit (int period, int budget)
+{
+  enum intr_level old_level;
+  int util;
+  bool ok;
+
+  if (period < 1 || budget < 1 || budget > period)
+    return false;
+
+  util = utilization (period, budget);
+  old_level = intr_disable ();
+  ok = total_util + util <= EDF_UTIL_LIMIT;
+  if (ok)
+    total_util += util;
+  intr_set_level (old_level);
+  return ok;
+}
+
+/* Releases the reservation made by edf_admit(PERIOD, BUDGET). */
+void
+edf_release (int period, int budget)
+{
+  enum intr_level old_level = intr_disable ();
+  total_util -= utilization (period, budget);
+  ASSERT (total_util >= 0);
+  intr_set_level (old_level);
+}
+
+/* Returns true if the thread owning A has an earlier deadline
+   than the one owning B. */
+static bool
+deadline_less (const struct list_elem *a, const struct list_elem *b,
+               void *aux UNUSED)
+{
+  return list_entry (a, struct thread, elem)->rt.deadline
+         < list_entry (b, struct thread, elem)->rt.deadline;
+}
+
+/* Returns true if a ready real-time thread should run instead of
+   CUR, the running thread. */
+bool
+edf_preempts (const struct thread *cur)
+{
+  const struct thread *first;
+
+  if (list_empty (&ready_list))
+    return false;
+  if (cur->rt.period == 0)
+    return true;
+
+  first = list_entry (list_front (&ready_list), struct thread, elem);
+  return first->rt.deadline < cur->rt.deadline;
+}
+
+static void
+edf_init (void)
+{
+  list_init (&ready_list);
+  total_util = 0;
+}
+
+/* Real-time threads are preempted by budget enforcement and by
+   earlier deadlines, not by the clock, so their slice is just
+   their budget. */
+static void
+edf_enqueue (struct thread *t)
+{
+  ASSERT (t->rt.period != 0);
+
+  t->time_slice = t->rt.budget;
+  list_insert_ordered (&ready_list, &t->elem, deadline_less, NULL);
+}
+
+static void
+edf_dequeue (struct thread *t)
+{
+  list_remove (&t->elem);
+}
+
+static struct thread *
+edf_pick_next (void)
+{
+  if (list_empty (&ready_list))
+    return NULL;
+  return list_entry (list_pop_front (&ready_list), struct thread, elem);
+}
+
+/* Charges the tick to CUR's budget if CUR is a real-time thread,
+   throttling it once the budget is gone, and asks for preemption
+   if a real-time thread should run instead of CUR. */
+static bool
+edf_tick (struct thread *cur, int64_t now UNUSED)
+{
+  if (cur->rt.period != 0 && --cur->rt.budget_left <= 0)
+    {
+      cur->rt.throttled = true;
+      return true;
+    }
+  return edf_preempts (cur);
+}
+
+static void
+edf_yield (struct thread *cur UNUSED)
+{
+}
+
+static void
+edf_wake (struct thread *t UNUSED)
+{
+}
+
+const struct sched_class sched_edf_class =
+  {
+    "edf",
+    edf_init,
+    edf_enqueue,
+    edf_dequeue,
+    edf_pick_next,
+    edf_tick,
+    edf_yield,
+    edf_wake,
+  };
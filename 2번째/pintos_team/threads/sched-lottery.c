@@ -0,0 +1,99 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <list.h>
+#include <random.h>
+#include "threads/runqueue.h"
+#include "threads/thread.h"
+
+/* Lottery scheduling.
+
+   Each READY thread holds sched_tickets() tickets.  To pick the
+   next thread, draw one ticket uniformly at random from all the
+   tickets held and run its owner.  In expectation each thread's
+   share of the CPU is proportional to its tickets; unlike stride
+   scheduling there is no state to carry between draws, at the
+   cost of a larger variance over short intervals.  See
+   C. A. Waldspurger and W. E. Weihl, "Lottery Scheduling:
+   Flexible Proportional-Share Resource Management", OSDI 1994. */
+
+/* READY threads, in no particular order. */
+static struct list ready_list;
+
+/* Total tickets held by threads in ready_list. */
+static unsigned long total_tickets;
+
+static void
+lottery_init (void)
+{
+  thread_mfq_levels = RQ_LEVELS_MAX;
+  list_init (&ready_list);
+  total_tickets = 0;
+}
+
+static void
+lottery_enqueue (struct thread *t)
+{
+  t->time_slice = SCHED_SHARE_SLICE;
+  list_push_back (&ready_list, &t->elem);
+  total_tickets += sched_tickets (t->priority);
+}
+
+static void
+lottery_dequeue (struct thread *t)
+{
+  list_remove (&t->elem);
+  total_tickets -= sched_tickets (t->priority);
+}
+
+static struct thread *
+lottery_pick_next (void)
+{
+  unsigned long winner;
+  struct list_elem *e;
+
+  if (list_empty (&ready_list))
+    return NULL;
+
+  winner = random_ulong () % total_tickets;
+  for (e = list_begin (&ready_list); ; e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, elem);
+      unsigned tickets = sched_tickets (t->priority);
+
+      ASSERT (e != list_end (&ready_list));
+      if (winner < tickets)
+        {
+          lottery_dequeue (t);
+          return t;
+        }
+      winner -= tickets;
+    }
+}
+
+static bool
+lottery_tick (struct thread *cur UNUSED, int64_t now UNUSED)
+{
+  return false;
+}
+
+static void
+lottery_yield (struct thread *cur UNUSED)
+{
+}
+
+static void
+lottery_wake (struct thread *t UNUSED)
+{
+}
+
+const struct sched_class sched_lottery_class =
+  {
+    "lottery",
+    lottery_init,
+    lottery_enqueue,
+    lottery_dequeue,
+    lottery_pick_next,
+    lottery_tick,
+    lottery_yield,
+    lottery_wake,
+  };
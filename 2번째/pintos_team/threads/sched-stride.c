@@ -0,0 +1,110 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <list.h>
+#include "threads/runqueue.h"
+#include "threads/thread.h"
+
+/* Stride scheduling.
+
+   Every thread has a `pass' value, a virtual time that advances
+   by its stride, STRIDE1 / tickets, for each tick it runs, so
+   that a thread with twice the tickets advances half as fast.
+   The thread with the lowest pass runs next.  Over any interval,
+   each thread's share of the CPU is then proportional to its
+   tickets, with an error of at most one slice.
+
+   A thread that was blocked for a while would come back with a
+   pass far behind everyone else's and monopolize the CPU until it
+   caught up, so on enqueue a thread's pass is first raised to
+   `global_pass', the pass of the thread most recently chosen to
+   run.  See C. A. Waldspurger and W. E. Weihl, "Stride
+   Scheduling", MIT/LCS/TM-528, 1995. */
+
+/* Dividend of all strides.  Large enough that integer division
+   by up to RQ_LEVELS_MAX tickets loses little. */
+#define STRIDE1 (1 << 20)
+
+/* READY threads, in order of increasing pass. */
+static struct list ready_list;
+
+/* Pass of the last thread picked to run. */
+static int64_t global_pass;
+
+/* Returns true if thread A's pass is lower than thread B's. */
+static bool
+pass_less (const struct list_elem *a_, const struct list_elem *b_,
+           void *aux UNUSED)
+{
+  const struct thread *a = list_entry (a_, struct thread, elem);
+  const struct thread *b = list_entry (b_, struct thread, elem);
+
+  return a->pass < b->pass;
+}
+
+static void
+stride_init (void)
+{
+  thread_mfq_levels = RQ_LEVELS_MAX;
+  list_init (&ready_list);
+  global_pass = 0;
+}
+
+static void
+stride_enqueue (struct thread *t)
+{
+  if (t->pass < global_pass)
+    t->pass = global_pass;
+  t->time_slice = SCHED_SHARE_SLICE;
+  list_insert_ordered (&ready_list, &t->elem, pass_less, NULL);
+}
+
+static void
+stride_dequeue (struct thread *t)
+{
+  list_remove (&t->elem);
+}
+
+static struct thread *
+stride_pick_next (void)
+{
+  struct thread *t;
+
+  if (list_empty (&ready_list))
+    return NULL;
+
+  t = list_entry (list_pop_front (&ready_list), struct thread, elem);
+  if (t->pass > global_pass)
+    global_pass = t->pass;
+  return t;
+}
+
+/* The idle thread is charged too, harmlessly, since it is never
+   enqueued. */
+static bool
+stride_tick (struct thread *cur, int64_t now UNUSED)
+{
+  cur->pass += STRIDE1 / sched_tickets (cur->priority);
+  return false;
+}
+
+static void
+stride_yield (struct thread *cur UNUSED)
+{
+}
+
+static void
+stride_wake (struct thread *t UNUSED)
+{
+}
+
+const struct sched_class sched_stride_class =
+  {
+    "stride",
+    stride_init,
+    stride_enqueue,
+    stride_dequeue,
+    stride_pick_next,
+    stride_tick,
+    stride_yield,
+    stride_wake,
+  };
@@ -0,0 +1,77 @@
+#ifndef THREADS_SCHED_H
+#define THREADS_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+
+/* A scheduling policy.
+
+   thread.c owns thread states, the idle thread, and context
+   switching; a scheduling class owns the set of READY threads
+   and decides which of them runs next and for how long.  All
+   functions are called with interrupts off.
+
+   Time slices are kept in each thread's `time_slice' member,
+   which a class sets when the thread is enqueued.  The running
+   thread is never in the class's ready set. */
+struct sched_class
+  {
+    const char *name;           /* Name, as given to -sched. */
+
+    /* Sets up an empty ready set.  Called once, from
+       thread_init(), before any thread exists. */
+    void (*init) (void);
+
+    /* Adds T, which has just become READY, to the ready set. */
+    void (*enqueue) (struct thread *t);
+
+    /* Removes T, which is READY, from the ready set.  Used when
+       T's priority changes. */
+    void (*dequeue) (struct thread *t);
+
+    /* Removes and returns the thread to run next, or a null
+       pointer if the ready set is empty. */
+    struct thread *(*pick_next) (void);
+
+    /* Charges timer tick NOW to CUR, the running thread, which
+       may be the idle thread.  Returns true to preempt CUR
+       before its slice runs out.  Interrupt context. */
+    bool (*tick) (struct thread *cur, int64_t now);
+
+    /* CUR, which is not the idle thread, is about to give up the
+       CPU and be enqueued again. */
+    void (*yield) (struct thread *cur);
+
+    /* T, which was blocked, is about to be enqueued again.
+       Interrupt context if T is woken by an interrupt handler. */
+    void (*wake) (struct thread *t);
+  };
+
+/* Proportional-share classes, in sched-stride.c and
+   sched-lottery.c.  Both give each thread a share of the CPU
+   proportional to sched_tickets(), that is, to its priority. */
+extern const struct sched_class sched_stride_class;
+extern const struct sched_class sched_lottery_class;
+
+/* Earliest-deadline-first class for periodic real-time threads,
+   in sched-edf.c.  It is not selectable with -sched; instead it
+   runs ahead of whichever class is, for the threads created with
+   thread_create_periodic(). */
+extern const struct sched_class sched_edf_class;
+bool edf_admit (int period, int budget);
+void edf_release (int period, int budget);
+bool edf_preempts (const struct thread *cur);
+
+/* Time slice of the proportional-share classes, in ticks. */
+#define SCHED_SHARE_SLICE 4
+
+/* Returns the number of tickets held by a thread at PRIORITY. */
+static inline unsigned
+sched_tickets (int priority)
+{
+  return priority + 1;
+}
+
+#endif /* threads/sched.h */
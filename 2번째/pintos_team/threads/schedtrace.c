@@ -0,0 +1,107 @@
+#include "threads/schedtrace.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/tsc.h"
+#include "devices/timer.h"
+
+/* Context-switch tracer.
+
+   Each call to schedule() appends one fixed-size event to a ring
+   buffer, overwriting the oldest once the buffer is full, so the
+   cost while tracing is a handful of stores.  At power off,
+   schedtrace_dump() prints the buffer over the console, one line
+   per event, for utils/schedtrace2json to turn into a Chrome
+   trace (load it at chrome://tracing or ui.perfetto.dev). */
+
+/* Number of events kept.  Must be a power of 2. */
+#define SCHEDTRACE_EVENTS 4096
+
+/* One scheduling decision. */
+struct schedtrace_event
+  {
+    uint64_t tsc;               /* Time-stamp counter at the switch. */
+    tid_t prev;                 /* Thread that stopped running. */
+    tid_t next;                 /* Thread that starts running. */
+    uint8_t reason;             /* Why PREV stopped: enum switch_reason. */
+    uint8_t prev_level;         /* PREV's priority. */
+    uint8_t next_level;         /* NEXT's priority. */
+  };
+
+bool schedtrace_enabled;
+
+static struct schedtrace_event events[SCHEDTRACE_EVENTS];
+static uint64_t event_cnt;      /* Events ever recorded. */
+
+/* When tracing started, to calibrate the time-stamp counter. */
+static uint64_t start_tsc;
+static int64_t start_tick;
+
+/* Records a switch from PREV to NEXT for REASON.  Called by
+   schedule() with interrupts off. */
+void
+schedtrace_record (const struct thread *prev, const struct thread *next,
+                   enum switch_reason reason)
+{
+  struct schedtrace_event *e;
+
+  if (!schedtrace_enabled)
+    return;
+
+  e = &events[event_cnt++ & (SCHEDTRACE_EVENTS - 1)];
+  e->tsc = tsc_read ();
+  e->prev = prev->tid;
+  e->next = next->tid;
+  e->reason = reason;
+  e->prev_level = prev->priority;
+  e->next_level = next->priority;
+
+  if (event_cnt == 1)
+    {
+      start_tsc = e->tsc;
+      start_tick = timer_ticks ();
+    }
+}
+
+/* Prints the name of thread T. */
+static void
+print_thread_name (struct thread *t, void *aux UNUSED)
+{
+  printf ("schedtrace: thread %d %s\n", t->tid, t->name);
+}
+
+/* Prints the recorded events, oldest first, preceded by the
+   TSC rate and the names of the threads still alive. */
+void
+schedtrace_dump (void)
+{
+  static const char *reasons[] = {"block", "yield", "preempt", "exit"};
+  enum intr_level old_level;
+  uint64_t first, i, cycles_per_us = 0;
+  int64_t ticks;
+
+  if (!schedtrace_enabled || event_cnt == 0)
+    return;
+
+  /* No more events while we print. */
+  old_level = intr_disable ();
+  schedtrace_enabled = false;
+  ticks = timer_ticks () - start_tick;
+  if (ticks > 0)
+    cycles_per_us = (tsc_read () - start_tsc) / (ticks * (1000000 / TIMER_FREQ));
+  first = event_cnt > SCHEDTRACE_EVENTS ? event_cnt - SCHEDTRACE_EVENTS : 0;
+
+  printf ("schedtrace: begin %llu events, %llu dropped, %llu cycles/us\n",
+          event_cnt - first, first, cycles_per_us);
+  thread_foreach (print_thread_name, NULL);
+  for (i = first; i < event_cnt; i++)
+    {
+      const struct schedtrace_event *e = &events[i & (SCHEDTRACE_EVENTS - 1)];
+      printf ("schedtrace: %llu %d %d %s %d %d\n",
+              e->tsc - start_tsc, e->prev, e->next, reasons[e->reason],
+              e->prev_level, e->next_level);
+    }
+  printf ("schedtrace: end\n");
+  intr_set_level (old_level);
+}
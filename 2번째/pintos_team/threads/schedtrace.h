@@ -0,0 +1,25 @@
+#ifndef THREADS_SCHEDTRACE_H
+#define THREADS_SCHEDTRACE_H
+
+#include <stdbool.h>
+
+struct thread;
+
+/* Why the running thread stopped running. */
+enum switch_reason
+  {
+    SWITCH_BLOCK,               /* Blocked, e.g. on a semaphore. */
+    SWITCH_YIELD,               /* Called thread_yield(). */
+    SWITCH_PREEMPT,             /* Preempted by the scheduler. */
+    SWITCH_EXIT                 /* Exited. */
+  };
+
+/* Whether to record scheduling decisions.  Controlled by kernel
+   command-line option "-trace". */
+extern bool schedtrace_enabled;
+
+void schedtrace_record (const struct thread *prev, const struct thread *next,
+                        enum switch_reason);
+void schedtrace_dump (void);
+
+#endif /* threads/schedtrace.h */
@@ -0,0 +1,181 @@
+#include "threads/softirq.h"
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/tsc.h"
+
+/* Items run per interrupt exit before the rest is left to
+   softirqd. */
+#define SOFTIRQ_BUDGET 8
+
+/* Raised work, one FIFO per priority. */
+static struct list queues[SOFTIRQ_PRIO_CNT];
+static unsigned pending_cnt;
+
+/* True while some item is running.  Keeps an interrupt that
+   arrives while softirqd runs an item from running others on top
+   of it, so that items never run concurrently with each other.
+   That interrupt must not preempt softirqd either, or nothing
+   would run until softirqd got the CPU back; see
+   softirq_running(). */
+static bool running;
+
+/* Wakes up softirqd when an interrupt exit leaves work behind. */
+static struct semaphore softirqd_wake;
+static bool softirqd_started;
+
+/* Statistics. */
+static long long irq_items;     /* Items run on interrupt exit. */
+static long long thread_items;  /* Items run by softirqd. */
+static uint64_t max_cycles;     /* Longest single item. */
+
+static void softirqd (void *aux);
+
+/* Initializes the softirq queues.  Called by intr_init(). */
+void
+softirq_init (void)
+{
+  int i;
+
+  for (i = 0; i < SOFTIRQ_PRIO_CNT; i++)
+    list_init (&queues[i]);
+  sema_init (&softirqd_wake, 0);
+}
+
+/* Starts softirqd.  Until then, leftover work waits for the next
+   interrupt exit.  Called after thread_start(). */
+void
+softirq_start (void)
+{
+  softirqd_started = thread_create ("softirqd", PRI_MAX, softirqd, NULL)
+                     != TID_ERROR;
+  if (!softirqd_started)
+    PANIC ("softirq: cannot create softirqd");
+}
+
+/* Initializes W to run FUNC with AUX when raised. */
+void
+softirq_work_init (struct softirq_work *w, softirq_func *func, void *aux)
+{
+  ASSERT (func != NULL);
+
+  w->func = func;
+  w->aux = aux;
+  w->pending = false;
+}
+
+/* Queues W at priority PRIO, unless it is already pending. */
+void
+softirq_raise (struct softirq_work *w, enum softirq_prio prio)
+{
+  enum intr_level old_level;
+
+  ASSERT (prio < SOFTIRQ_PRIO_CNT);
+
+  old_level = intr_disable ();
+  if (!w->pending)
+    {
+      w->pending = true;
+      list_push_back (&queues[prio], &w->elem);
+      pending_cnt++;
+    }
+  intr_set_level (old_level);
+}
+
+/* Returns true if any work is waiting to run. */
+bool
+softirq_pending (void)
+{
+  return pending_cnt > 0;
+}
+
+/* Returns true if an item is running.  An interrupt exit that
+   finds one running interrupted softirqd in the middle of it and
+   must leave any yield to softirqd, which yields after each
+   batch of items. */
+bool
+softirq_running (void)
+{
+  return running;
+}
+
+/* Runs up to BUDGET items, highest priority first, with
+   interrupts on, and returns the number run.  Must be called
+   with interrupts off, and returns with them off. */
+static int
+run_items (int budget)
+{
+  int done = 0;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (running)
+    return 0;
+  running = true;
+  while (done < budget && pending_cnt > 0)
+    {
+      struct softirq_work *w = NULL;
+      uint64_t start;
+      int i;
+
+      for (i = 0; w == NULL; i++)
+        if (!list_empty (&queues[i]))
+          w = list_entry (list_pop_front (&queues[i]),
+                          struct softirq_work, elem);
+      w->pending = false;
+      pending_cnt--;
+
+      intr_enable ();
+      start = tsc_read ();
+      w->func (w->aux);
+      start = tsc_read () - start;
+      intr_disable ();
+
+      if (start > max_cycles)
+        max_cycles = start;
+      done++;
+    }
+  running = false;
+  return done;
+}
+
+/* Runs pending work on exit from an external interrupt, handing
+   whatever exceeds the budget to softirqd.  Called by
+   intr_handler() with interrupts off. */
+void
+softirq_run (void)
+{
+  irq_items += run_items (SOFTIRQ_BUDGET);
+  if (pending_cnt > 0 && softirqd_started)
+    sema_up (&softirqd_wake);
+}
+
+/* Runs work left over by interrupt exits, a budget's worth at a
+   time, yielding in between so that it cannot hog the CPU. */
+static void
+softirqd (void *aux UNUSED)
+{
+  for (;;)
+    {
+      sema_down (&softirqd_wake);
+
+      intr_disable ();
+      while (pending_cnt > 0)
+        {
+          thread_items += run_items (SOFTIRQ_BUDGET);
+          thread_yield ();
+        }
+      intr_enable ();
+    }
+}
+
+/* Prints softirq statistics. */
+void
+softirq_print_stats (void)
+{
+  printf ("Softirq: %lld items on interrupt exit, %lld in softirqd, "
+          "longest %llu cycles\n", irq_items, thread_items, max_cycles);
+}
@@ -0,0 +1,57 @@
+#ifndef THREADS_SOFTIRQ_H
+#define THREADS_SOFTIRQ_H
+
+#include <list.h>
+#include <stdbool.h>
+
+/* Deferred work ("softirqs").
+
+   An external interrupt handler runs with interrupts off, so
+   everything it does delays every other interrupt.  A handler
+   can instead do the urgent part itself, such as acknowledging
+   the device, and raise a work item for the rest.  Raised work
+   runs as soon as the interrupt handler returns, with interrupts
+   back on, before the interrupted thread resumes.  Work is still
+   interrupt context: it may not sleep, but it may call
+   intr_yield_on_return().
+
+   Each interrupt exit runs at most SOFTIRQ_BUDGET items.  Any
+   left over are run by the "softirqd" kernel thread, so that a
+   storm of interrupts cannot starve threads indefinitely; work
+   run there is in thread context instead.
+
+   A work item is embedded in the structure it serves and raising
+   it needs no memory allocation.  Raising an item that is
+   already pending does nothing, so work must be written to
+   handle everything that accumulated since it was raised. */
+
+/* Queues, run in this order. */
+enum softirq_prio
+  {
+    SOFTIRQ_HI,                 /* Most urgent. */
+    SOFTIRQ_TIMER,              /* Timer wakeups and scheduler aging. */
+    SOFTIRQ_BLOCK,              /* Block device completions. */
+    SOFTIRQ_PRIO_CNT
+  };
+
+typedef void softirq_func (void *aux);
+
+/* A work item. */
+struct softirq_work
+  {
+    struct list_elem elem;      /* Element in a softirq queue. */
+    softirq_func *func;         /* Function to run. */
+    void *aux;                  /* Argument to FUNC. */
+    bool pending;               /* True while queued. */
+  };
+
+void softirq_init (void);
+void softirq_start (void);
+void softirq_work_init (struct softirq_work *, softirq_func *, void *aux);
+void softirq_raise (struct softirq_work *, enum softirq_prio);
+bool softirq_pending (void);
+bool softirq_running (void);
+void softirq_run (void);
+void softirq_print_stats (void);
+
+#endif /* threads/softirq.h */
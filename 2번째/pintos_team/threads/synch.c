@@ -29,8 +29,43 @@
 #include "threads/synch.h"
 #include <stdio.h>
 #include <string.h>
+#include "threads/atomic.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#ifdef LOCK_PROFILE
+#include "threads/tsc.h"
+#endif
+
+static void lock_acquire_slow (struct lock *);
+static void lock_release_slow (struct lock *);
+static bool thread_priority_less (const struct list_elem *,
+                                  const struct list_elem *, void *aux);
+static bool waiter_priority_less (const struct list_elem *,
+                                  const struct list_elem *, void *aux);
+static void wake_all (struct list *);
+static bool sema_elem_priority_less (const struct list_elem *,
+                                     const struct list_elem *, void *aux);
+
+/* A thread waiting on a semaphore.  A thread in sema_down_any()
+   waits on several semaphores at once, with one of these in each
+   of their waiters lists, all in one array: waking the thread
+   through any of them takes it off all of them. */
+struct sema_waiter
+  {
+    struct list_elem elem;      /* Element in semaphore's waiters. */
+    struct thread *thread;      /* Waiting thread. */
+    struct sema_waiter *set;    /* First of the thread's waiters. */
+    size_t set_cnt;             /* Number of the thread's waiters. */
+    bool woken;                 /* Whether this one woke the thread. */
+  };
+
+#ifdef LOCK_PROFILE
+/* Locks that have a name, for lock_print_stats(). */
+static struct list named_locks = LIST_INITIALIZER (named_locks);
+
+static void profile_acquired (struct lock *, uint64_t wait_start);
+static void profile_released (struct lock *);
+#endif
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -68,13 +103,78 @@ sema_down (struct semaphore *sema)
   old_level = intr_disable ();
   while (sema->value == 0) 
     {
-      list_push_back (&sema->waiters, &thread_current ()->elem);
+      struct sema_waiter w;
+
+      w.thread = thread_current ();
+      w.set = &w;
+      w.set_cnt = 1;
+      w.woken = false;
+      list_push_back (&sema->waiters, &w.elem);
       thread_block ();
     }
   sema->value--;
   intr_set_level (old_level);
 }
 
+/* Waits until any of the CNT semaphores in SEMAS, at most
+   SEMA_ANY_MAX, is positive, decrements it, and returns its
+   index.  If several are positive, the one with the lowest index
+   is taken.
+
+   The thread waits in all of the semaphores' lists at once, and
+   the first sema_up() on any of them wakes it, so it wakes once
+   however many semaphores it waits on.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler.  This function may be called with
+   interrupts disabled, but if it sleeps then the next scheduled
+   thread will probably turn interrupts back on. */
+size_t
+sema_down_any (struct semaphore *semas[], size_t cnt)
+{
+  struct sema_waiter waiters[SEMA_ANY_MAX];
+  enum intr_level old_level;
+  size_t woken = cnt;
+  size_t i;
+
+  ASSERT (semas != NULL);
+  ASSERT (cnt > 0 && cnt <= SEMA_ANY_MAX);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  for (;;)
+    {
+      /* Take the semaphore that woke us, if it is still up: its
+         sema_up() was meant for us, and leaving it for a thread
+         that sleeps in it would lose that wakeup. */
+      if (woken < cnt && semas[woken]->value > 0)
+        i = woken;
+      else
+        for (i = 0; i < cnt; i++)
+          if (semas[i]->value > 0)
+            break;
+      if (i < cnt)
+        break;
+
+      for (i = 0; i < cnt; i++)
+        {
+          waiters[i].thread = thread_current ();
+          waiters[i].set = waiters;
+          waiters[i].set_cnt = cnt;
+          waiters[i].woken = false;
+          list_push_back (&semas[i]->waiters, &waiters[i].elem);
+        }
+      thread_block ();
+      for (woken = 0; woken < cnt; woken++)
+        if (waiters[woken].woken)
+          break;
+    }
+  semas[i]->value--;
+  intr_set_level (old_level);
+
+  return i;
+}
+
 /* Down or "P" operation on a semaphore, but only if the
    semaphore is not already 0.  Returns true if the semaphore is
    decremented, false otherwise.
@@ -102,7 +202,9 @@ sema_try_down (struct semaphore *sema)
 }
 
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up the highest-priority thread of those waiting for
+   SEMA, if any.  Priorities are compared at wakeup time, so
+   donations received while waiting are taken into account.
 
    This function may be called from an interrupt handler. */
 void
@@ -114,8 +216,18 @@ sema_up (struct semaphore *sema)
 
   old_level = intr_disable ();
   if (!list_empty (&sema->waiters)) 
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                                struct thread, elem));
+    {
+      struct sema_waiter *w = list_entry (list_max (&sema->waiters,
+                                                    waiter_priority_less,
+                                                    NULL),
+                                          struct sema_waiter, elem);
+      size_t i;
+
+      for (i = 0; i < w->set_cnt; i++)
+        list_remove (&w->set[i].elem);
+      w->woken = true;
+      thread_unblock (w->thread);
+    }
   sema->value++;
   intr_set_level (old_level);
 }
@@ -174,11 +286,33 @@ sema_test_helper (void *sema_)
    instead of a lock. */
 void
 lock_init (struct lock *lock)
+{
+  lock_init_named (lock, NULL);
+}
+
+/* Initializes LOCK like lock_init() and, in kernels built with
+   -DLOCK_PROFILE, gives it NAME, under which lock_print_stats()
+   lists it.  A named lock must never be freed or initialized
+   again.  Several locks may share a name. */
+void
+lock_init_named (struct lock *lock, const char *name)
 {
   ASSERT (lock != NULL);
 
-  lock->holder = NULL;
-  sema_init (&lock->semaphore, 1);
+  lock->owner = 0;
+  list_init (&lock->waiters);
+#ifdef LOCK_PROFILE
+  memset (&lock->profile, 0, sizeof lock->profile);
+  lock->profile.name = name;
+  if (name != NULL)
+    {
+      enum intr_level old_level = intr_disable ();
+      list_push_back (&named_locks, &lock->profile.elem);
+      intr_set_level (old_level);
+    }
+#else
+  (void) name;
+#endif
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -188,16 +322,70 @@ lock_init (struct lock *lock)
    This function may sleep, so it must not be called within an
    interrupt handler.  This function may be called with
    interrupts disabled, but interrupts will be turned back on if
-   we need to sleep. */
+   we need to sleep.
+
+   If LOCK is held, the current thread donates its priority to
+   the holder, and through it to the holders of any locks the
+   holder is itself waiting for, until it obtains LOCK. */
 void
 lock_acquire (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
-  sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  if (!atomic_cmpxchg (&lock->owner, 0, (uintptr_t) cur))
+    lock_acquire_slow (lock);
+#ifdef LOCK_PROFILE
+  else
+    profile_acquired (lock, 0);
+#endif
+}
+
+/* Waits for LOCK, which was held a moment ago.  The releasing
+   thread hands LOCK straight to the highest-priority waiter and
+   wakes it, so a woken waiter already holds LOCK and does not
+   race for it with the other waiters or with newcomers. */
+static void
+lock_acquire_slow (struct lock *lock)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+#ifdef LOCK_PROFILE
+  uint64_t wait_start = tsc_read ();
+#endif
+
+  old_level = intr_disable ();
+  for (;;)
+    {
+      uintptr_t owner = lock->owner;
+
+      if (owner == 0)
+        {
+          /* Released in the meantime. */
+          if (atomic_cmpxchg (&lock->owner, 0, (uintptr_t) cur))
+            break;
+        }
+      else if ((owner & LOCK_WAITERS)
+               || atomic_cmpxchg (&lock->owner, owner, owner | LOCK_WAITERS))
+        {
+          /* The holder can no longer release LOCK without taking
+             the slow path, which hands it over to us. */
+          cur->wait_on_lock = lock;
+          if (!thread_mlfqs)
+            thread_donate_priority (cur);
+          list_push_back (&lock->waiters, &cur->elem);
+          thread_block ();
+          ASSERT (lock_holder (lock) == cur);
+          break;
+        }
+    }
+  intr_set_level (old_level);
+#ifdef LOCK_PROFILE
+  profile_acquired (lock, wait_start);
+#endif
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -209,18 +397,19 @@ lock_acquire (struct lock *lock)
 bool
 lock_try_acquire (struct lock *lock)
 {
-  bool success;
-
   ASSERT (lock != NULL);
   ASSERT (!lock_held_by_current_thread (lock));
 
-  success = sema_try_down (&lock->semaphore);
-  if (success)
-    lock->holder = thread_current ();
-  return success;
+  if (!atomic_cmpxchg (&lock->owner, 0, (uintptr_t) thread_current ()))
+    return false;
+#ifdef LOCK_PROFILE
+  profile_acquired (lock, 0);
+#endif
+  return true;
 }
 
-/* Releases LOCK, which must be owned by the current thread.
+/* Releases LOCK, which must be owned by the current thread,
+   giving up any priority donated through it.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to release a lock within an interrupt
@@ -231,8 +420,50 @@ lock_release (struct lock *lock)
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
-  lock->holder = NULL;
-  sema_up (&lock->semaphore);
+#ifdef LOCK_PROFILE
+  profile_released (lock);
+#endif
+  /* Nobody waits, so nobody donated through LOCK either. */
+  if (!atomic_cmpxchg (&lock->owner, (uintptr_t) thread_current (), 0))
+    lock_release_slow (lock);
+}
+
+/* Releases LOCK, which has waiters, by handing it to the
+   highest-priority one.  The waiters left behind now wait for
+   the new holder, so their donations move over to it. */
+static void
+lock_release_slow (struct lock *lock)
+{
+  enum intr_level old_level;
+  struct thread *next;
+  struct list_elem *e;
+
+  old_level = intr_disable ();
+  if (!thread_mlfqs)
+    thread_remove_donations (lock);
+  if (list_empty (&lock->waiters))
+    {
+      lock->owner = 0;
+      intr_set_level (old_level);
+      return;
+    }
+
+  e = list_max (&lock->waiters, thread_priority_less, NULL);
+  list_remove (e);
+  next = list_entry (e, struct thread, elem);
+  next->wait_on_lock = NULL;
+  if (!thread_mlfqs)
+    {
+      for (e = list_begin (&lock->waiters); e != list_end (&lock->waiters);
+           e = list_next (e))
+        list_push_back (&next->donors,
+                        &list_entry (e, struct thread, elem)->donor_elem);
+      thread_refresh_priority (next);
+    }
+  lock->owner = (uintptr_t) next
+                | (list_empty (&lock->waiters) ? 0 : LOCK_WAITERS);
+  thread_unblock (next);
+  intr_set_level (old_level);
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -243,14 +474,495 @@ lock_held_by_current_thread (const struct lock *lock)
 {
   ASSERT (lock != NULL);
 
-  return lock->holder == thread_current ();
+  return lock_holder (lock) == thread_current ();
+}
+
+#ifdef LOCK_PROFILE
+/* Records that the current thread just acquired LOCK, after
+   waiting since WAIT_START, or without waiting if WAIT_START is
+   0.  The statistics are only touched by LOCK's holder, so LOCK
+   itself protects them. */
+static void
+profile_acquired (struct lock *lock, uint64_t wait_start)
+{
+  struct lock_profile *p = &lock->profile;
+  uint64_t now = tsc_read ();
+
+  p->acquired++;
+  if (wait_start != 0)
+    {
+      uint64_t wait = now - wait_start;
+
+      p->contended++;
+      p->wait_cycles += wait;
+      if (wait > p->max_wait_cycles)
+        p->max_wait_cycles = wait;
+    }
+  p->acquired_at = now;
+}
+
+/* Records that the current thread is about to release LOCK. */
+static void
+profile_released (struct lock *lock)
+{
+  struct lock_profile *p = &lock->profile;
+  uint64_t hold = tsc_read () - p->acquired_at;
+
+  p->hold_cycles += hold;
+  if (hold > p->max_hold_cycles)
+    p->max_hold_cycles = hold;
+}
+#endif
+
+/* Most locks listed by lock_print_stats(). */
+#define LOCKSTAT_TOP 10
+
+/* Prints the statistics of the LOCKSTAT_TOP named locks that were
+   contended most often, most contended first. */
+void
+lock_print_stats (void)
+{
+#ifdef LOCK_PROFILE
+  struct lock *top[LOCKSTAT_TOP];
+  struct list_elem *e;
+  int top_cnt = 0;
+  int i;
+
+  for (e = list_begin (&named_locks); e != list_end (&named_locks);
+       e = list_next (e))
+    {
+      struct lock *lock = list_entry (e, struct lock, profile.elem);
+
+      /* Insertion sort into TOP, dropping whatever falls off the
+         end. */
+      for (i = top_cnt;
+           i > 0 && top[i - 1]->profile.contended < lock->profile.contended;
+           i--)
+        if (i < LOCKSTAT_TOP)
+          top[i] = top[i - 1];
+      if (i < LOCKSTAT_TOP)
+        {
+          top[i] = lock;
+          if (top_cnt < LOCKSTAT_TOP)
+            top_cnt++;
+        }
+    }
+
+  for (i = 0; i < top_cnt; i++)
+    {
+      struct lock *lock = top[i];
+      struct lock_profile *p = &lock->profile;
+
+      printf ("Lock: %-12s %p: %u acquired, %u contended, "
+              "wait %llu cycles (max %llu), hold %llu cycles avg "
+              "(max %llu)\n",
+              p->name, lock, p->acquired, p->contended, p->wait_cycles,
+              p->max_wait_cycles,
+              p->acquired > 0 ? p->hold_cycles / p->acquired : 0,
+              p->max_hold_cycles);
+    }
+#else
+  printf ("Lock profiling is disabled; "
+          "build the kernel with -DLOCK_PROFILE.\n");
+#endif
 }
 
+/* Initializes RW, unheld.  See struct rwlock for how it differs
+   from a lock. */
+void
+rwlock_init (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  rw->readers = 0;
+  rw->writer = NULL;
+  rw->upgrader = NULL;
+  list_init (&rw->read_waiters);
+  list_init (&rw->write_waiters);
+}
+
+/* Returns true if a new reader of RW would have to wait: some
+   thread holds it for writing or waits to. */
+static bool
+rwlock_readers_barred (struct rwlock *rw)
+{
+  return (rw->writer != NULL || rw->upgrader != NULL
+          || !list_empty (&rw->write_waiters));
+}
+
+/* Acquires RW for reading, sleeping while some thread holds it
+   for writing or waits to.  The current thread must not already
+   hold RW.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler.  This function may be called with
+   interrupts disabled, but interrupts will be turned back on if
+   we need to sleep. */
+void
+rwlock_acquire_read (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  old_level = intr_disable ();
+  if (rwlock_readers_barred (rw))
+    {
+      /* The thread that lets us in counts us as a reader. */
+      list_push_back (&rw->read_waiters, &thread_current ()->elem);
+      thread_block ();
+    }
+  else
+    rw->readers++;
+  intr_set_level (old_level);
+}
+
+/* Acquires RW for reading and returns true if that can be done
+   without sleeping, or returns false.  This function will not
+   sleep, so it may be called within an interrupt handler. */
+bool
+rwlock_try_acquire_read (struct rwlock *rw)
+{
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  success = !rwlock_readers_barred (rw);
+  if (success)
+    rw->readers++;
+  intr_set_level (old_level);
+  return success;
+}
+
+/* Hands RW, which nobody holds for writing, to the
+   highest-priority waiting writer if no readers are left, or
+   else lets in all waiting readers if no writer waits.  The
+   woken threads already hold RW.  Interrupts must be off. */
+static void
+rwlock_wake (struct rwlock *rw)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (rw->writer == NULL);
+
+  if (rw->upgrader != NULL)
+    {
+      /* The upgrader is the last reader, if it is the only one. */
+      if (rw->readers == 1)
+        {
+          rw->readers = 0;
+          rw->writer = rw->upgrader;
+          rw->upgrader = NULL;
+          thread_unblock (rw->writer);
+        }
+    }
+  else if (!list_empty (&rw->write_waiters))
+    {
+      if (rw->readers == 0)
+        {
+          struct list_elem *e = list_max (&rw->write_waiters,
+                                          thread_priority_less, NULL);
+          list_remove (e);
+          rw->writer = list_entry (e, struct thread, elem);
+          thread_unblock (rw->writer);
+        }
+    }
+  else
+    while (!list_empty (&rw->read_waiters))
+      {
+        rw->readers++;
+        thread_unblock (list_entry (list_pop_front (&rw->read_waiters),
+                                    struct thread, elem));
+      }
+}
+
+/* Releases RW, which the current thread holds for reading. */
+void
+rwlock_release_read (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (rw->readers > 0);
+  ASSERT (rw->upgrader != thread_current ());
+
+  old_level = intr_disable ();
+  rw->readers--;
+  rwlock_wake (rw);
+  intr_set_level (old_level);
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it.  The current thread must not already hold RW.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler.  This function may be called with
+   interrupts disabled, but interrupts will be turned back on if
+   we need to sleep. */
+void
+rwlock_acquire_write (struct rwlock *rw)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != cur);
+
+  old_level = intr_disable ();
+  if (rw->writer != NULL || rw->readers > 0 || rw->upgrader != NULL)
+    {
+      /* The thread that lets us in makes us the writer. */
+      list_push_back (&rw->write_waiters, &cur->elem);
+      thread_block ();
+      ASSERT (rw->writer == cur);
+    }
+  else
+    rw->writer = cur;
+  intr_set_level (old_level);
+}
+
+/* Acquires RW for writing and returns true if that can be done
+   without sleeping, or returns false.  This function will not
+   sleep, so it may be called within an interrupt handler. */
+bool
+rwlock_try_acquire_write (struct rwlock *rw)
+{
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  success = (rw->writer == NULL && rw->readers == 0
+             && rw->upgrader == NULL);
+  if (success)
+    rw->writer = thread_current ();
+  intr_set_level (old_level);
+  return success;
+}
+
+/* Releases RW, which the current thread holds for writing. */
+void
+rwlock_release_write (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  old_level = intr_disable ();
+  rw->writer = NULL;
+  rwlock_wake (rw);
+  intr_set_level (old_level);
+}
+
+/* Turns the current thread's read hold on RW into a write hold,
+   sleeping until the other readers are gone, and returns true.
+   Waiting writers do not get in first, but only one reader at a
+   time can wait to upgrade, since two would wait for each other
+   forever: if another reader already waits, returns false at
+   once, still holding RW for reading.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+rwlock_upgrade (struct rwlock *rw)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  bool success = true;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->readers > 0);
+
+  old_level = intr_disable ();
+  if (rw->readers == 1)
+    {
+      rw->readers = 0;
+      rw->writer = cur;
+    }
+  else if (rw->upgrader == NULL)
+    {
+      /* The last other reader to leave makes us the writer. */
+      rw->upgrader = cur;
+      thread_block ();
+      ASSERT (rw->writer == cur);
+    }
+  else
+    success = false;
+  intr_set_level (old_level);
+  return success;
+}
+
+/* Turns the current thread's read hold on RW into a write hold
+   and returns true if it is the only reader, or returns false,
+   still holding RW for reading. */
+bool
+rwlock_try_upgrade (struct rwlock *rw)
+{
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (rw != NULL);
+  ASSERT (rw->readers > 0);
+
+  old_level = intr_disable ();
+  success = rw->readers == 1 && rw->upgrader == NULL;
+  if (success)
+    {
+      rw->readers = 0;
+      rw->writer = thread_current ();
+    }
+  intr_set_level (old_level);
+  return success;
+}
+
+/* Turns the current thread's write hold on RW into a read hold,
+   letting in the waiting readers too, unless a writer waits. */
+void
+rwlock_downgrade (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  old_level = intr_disable ();
+  rw->writer = NULL;
+  rw->readers = 1;
+  rwlock_wake (rw);
+  intr_set_level (old_level);
+}
+
+/* Returns true if the current thread holds RW for writing, false
+   otherwise.  (There is no way to tell whether it holds RW for
+   reading.) */
+bool
+rwlock_held_for_write (const struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  return rw->writer == thread_current ();
+}
+
+/* Initializes LATCH to open after COUNT calls to
+   latch_count_down(), or at once if COUNT is 0. */
+void
+latch_init (struct latch *latch, unsigned count)
+{
+  ASSERT (latch != NULL);
+
+  latch->count = count;
+  list_init (&latch->waiters);
+}
+
+/* Counts LATCH down by one, and wakes all of its waiters if that
+   brings it to zero.  LATCH must not be open already.
+
+   This function may be called from an interrupt handler. */
+void
+latch_count_down (struct latch *latch)
+{
+  enum intr_level old_level;
+
+  ASSERT (latch != NULL);
+
+  old_level = intr_disable ();
+  ASSERT (latch->count > 0);
+  if (--latch->count == 0)
+    wake_all (&latch->waiters);
+  intr_set_level (old_level);
+}
+
+/* Waits until LATCH has been counted down to zero.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+latch_wait (struct latch *latch)
+{
+  enum intr_level old_level;
+
+  ASSERT (latch != NULL);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  if (latch->count > 0)
+    {
+      list_push_back (&latch->waiters, &thread_current ()->elem);
+      thread_block ();
+    }
+  intr_set_level (old_level);
+}
+
+/* Initializes B for rounds of PARTIES threads each. */
+void
+barrier_init (struct barrier *b, unsigned parties)
+{
+  ASSERT (b != NULL);
+  ASSERT (parties > 0);
+
+  b->parties = parties;
+  b->arrived = 0;
+  list_init (&b->waiters);
+}
+
+/* Waits until all of B's parties have called this function in
+   the current round, and then starts the next round.  Returns
+   true in the thread that arrived last, which never sleeps, and
+   false in the others, so that one thread can act for them all.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+barrier_wait (struct barrier *b)
+{
+  enum intr_level old_level;
+  bool last;
+
+  ASSERT (b != NULL);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  last = ++b->arrived == b->parties;
+  if (last)
+    {
+      b->arrived = 0;
+      wake_all (&b->waiters);
+    }
+  else
+    {
+      list_push_back (&b->waiters, &thread_current ()->elem);
+      thread_block ();
+    }
+  intr_set_level (old_level);
+
+  return last;
+}
+
+/* Wakes every thread in WAITERS, a list of blocked threads, in
+   one pass, leaving it empty.  Interrupts must be off. */
+static void
+wake_all (struct list *waiters)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (!list_empty (waiters))
+    thread_unblock (list_entry (list_pop_front (waiters),
+                                struct thread, elem));
+}
+
 /* One semaphore in a list. */
 struct semaphore_elem 
   {
     struct list_elem elem;              /* List element. */
     struct semaphore semaphore;         /* This semaphore. */
+    struct thread *thread;              /* Thread waiting on it. */
   };
 
 /* Initializes condition variable COND.  A condition variable
@@ -295,6 +1007,7 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
+  waiter.thread = thread_current ();
   list_push_back (&cond->waiters, &waiter.elem);
   lock_release (lock);
   sema_down (&waiter.semaphore);
@@ -302,8 +1015,9 @@ cond_wait (struct condition *cond, struct lock *lock)
 }
 
 /* If any threads are waiting on COND (protected by LOCK), then
-   this function signals one of them to wake up from its wait.
-   LOCK must be held before calling this function.
+   this function signals the highest-priority one of them to wake
+   up from its wait.  LOCK must be held before calling this
+   function.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to signal a condition variable within an
@@ -317,8 +1031,12 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (lock_held_by_current_thread (lock));
 
   if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+    {
+      struct list_elem *e = list_max (&cond->waiters,
+                                      sema_elem_priority_less, NULL);
+      list_remove (e);
+      sema_up (&list_entry (e, struct semaphore_elem, elem)->semaphore);
+    }
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -336,3 +1054,33 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   while (!list_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Returns true if the thread owning list element A (through its
+   `elem') has lower priority than the one owning B. */
+static bool
+thread_priority_less (const struct list_elem *a, const struct list_elem *b,
+                      void *aux UNUSED)
+{
+  return list_entry (a, struct thread, elem)->priority
+         < list_entry (b, struct thread, elem)->priority;
+}
+
+/* Returns true if the thread owning semaphore waiter A has lower
+   priority than the one owning B. */
+static bool
+waiter_priority_less (const struct list_elem *a, const struct list_elem *b,
+                      void *aux UNUSED)
+{
+  return list_entry (a, struct sema_waiter, elem)->thread->priority
+         < list_entry (b, struct sema_waiter, elem)->thread->priority;
+}
+
+/* Returns true if the thread waiting on condition variable
+   waiter A has lower priority than the one waiting on B. */
+static bool
+sema_elem_priority_less (const struct list_elem *a,
+                         const struct list_elem *b, void *aux UNUSED)
+{
+  return list_entry (a, struct semaphore_elem, elem)->thread->priority
+         < list_entry (b, struct semaphore_elem, elem)->thread->priority;
+}
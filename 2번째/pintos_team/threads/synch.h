@@ -3,6 +3,7 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* A counting semaphore. */
 struct semaphore 
@@ -11,24 +12,128 @@ struct semaphore
     struct list waiters;        /* List of waiting threads. */
   };
 
+/* Most semaphores sema_down_any() can wait on at once. */
+#define SEMA_ANY_MAX 32
+
 void sema_init (struct semaphore *, unsigned value);
 void sema_down (struct semaphore *);
+size_t sema_down_any (struct semaphore *semas[], size_t cnt);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
 
-/* Lock. */
+#ifdef LOCK_PROFILE
+/* Contention statistics of a lock, kept only in kernels built
+   with -DLOCK_PROFILE.  Times are in CPU cycles. */
+struct lock_profile
+  {
+    const char *name;           /* Name, or null if not listed. */
+    struct list_elem elem;      /* Element in list of named locks. */
+    unsigned acquired;          /* Times acquired. */
+    unsigned contended;         /* Times acquired after waiting. */
+    uint64_t wait_cycles;       /* Cycles spent waiting. */
+    uint64_t max_wait_cycles;   /* Longest wait. */
+    uint64_t hold_cycles;       /* Cycles held. */
+    uint64_t max_hold_cycles;   /* Longest hold. */
+    uint64_t acquired_at;       /* When last acquired. */
+  };
+#endif
+
+/* Lock.
+
+   `owner' is in one of three states: 0 if the lock is free, the
+   holder's address if it is held and nobody waits, or the
+   holder's address plus LOCK_WAITERS if threads may be waiting.
+   Thread structures are page-aligned, so the low bit is free to
+   use.  Acquiring a free lock and releasing one nobody waits for
+   each take a single compare-and-exchange, with interrupts left
+   alone.  Only the contended case takes interrupts off to use
+   the waiter list. */
 struct lock 
   {
-    struct thread *holder;      /* Thread holding lock (for debugging). */
-    struct semaphore semaphore; /* Binary semaphore controlling access. */
+    volatile uintptr_t owner;   /* Holder, plus LOCK_WAITERS. */
+    struct list waiters;        /* Threads waiting for the lock. */
+#ifdef LOCK_PROFILE
+    struct lock_profile profile; /* Contention statistics. */
+#endif
   };
 
+#define LOCK_WAITERS 1
+
+/* Returns the thread holding LOCK, or a null pointer if LOCK is
+   free. */
+static inline struct thread *
+lock_holder (const struct lock *lock)
+{
+  return (struct thread *) (lock->owner & ~(uintptr_t) LOCK_WAITERS);
+}
+
 void lock_init (struct lock *);
+void lock_init_named (struct lock *, const char *name);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+void lock_print_stats (void);
+
+/* Reader-writer lock.
+
+   Any number of readers, or a single writer, may hold it at
+   once.  Writers are preferred: once a writer waits, new readers
+   wait behind it, so a steady stream of readers cannot starve
+   writers.  Readers are not tracked individually, so a thread
+   must not take the lock for reading twice, and readers do not
+   receive priority donation. */
+struct rwlock
+  {
+    int readers;                /* Threads holding it for reading. */
+    struct thread *writer;      /* Thread holding it for writing. */
+    struct thread *upgrader;    /* Reader waiting to become writer. */
+    struct list read_waiters;   /* Threads waiting to read. */
+    struct list write_waiters;  /* Threads waiting to write. */
+  };
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+bool rwlock_try_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+bool rwlock_try_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_upgrade (struct rwlock *);
+bool rwlock_try_upgrade (struct rwlock *);
+void rwlock_downgrade (struct rwlock *);
+bool rwlock_held_for_write (const struct rwlock *);
+
+/* Countdown latch.
+
+   Threads wait until the count, set once at initialization,
+   has been counted down to zero, and are then all woken at once.
+   After that, the latch stays open. */
+struct latch
+  {
+    unsigned count;             /* Count-downs still needed. */
+    struct list waiters;        /* Threads waiting for zero. */
+  };
+
+void latch_init (struct latch *, unsigned count);
+void latch_count_down (struct latch *);
+void latch_wait (struct latch *);
+
+/* Barrier.
+
+   Each of a fixed number of parties waits until all of them have
+   arrived, and then they are all woken at once.  The barrier is
+   then ready for their next round. */
+struct barrier
+  {
+    unsigned parties;           /* Threads per round. */
+    unsigned arrived;           /* Threads arrived this round. */
+    struct list waiters;        /* Arrived threads, except the last. */
+  };
+
+void barrier_init (struct barrier *, unsigned parties);
+bool barrier_wait (struct barrier *);
 
 /* Condition variable. */
 struct condition 
@@ -3,14 +3,24 @@
 #include <stddef.h>
 #include <random.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <wheel.h>
 #include "threads/flags.h"
+#include "threads/group.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/mfq-policy.h"
 #include "threads/palloc.h"
+#include "threads/runqueue.h"
+#include "threads/sched.h"
+#include "threads/schedtrace.h"
+#include "threads/softirq.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
+#include "threads/tsc.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
@@ -20,18 +30,43 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
+/* Multilevel feedback queue of processes in THREAD_READY state,
+   that is, processes that are ready to run but not actually
+   running.  One level per priority.  Used by the MFQ and 4.4BSD
+   scheduling classes; the others keep their own ready sets. */
+static struct runqueue ready_queue;
 
-static struct list ready_list[5];   // 우선순위별 Feadback Queue를 다섯 개 만들어준다. 
+/* Scheduling class in use, chosen by name with "-sched=NAME"
+   on the kernel command line.  The default is "mfq". */
+const char *thread_sched_name;
+static const struct sched_class *sched;
 
+/* Number of MFQ levels and per-level time slices, set from the
+   kernel command line before thread_init() runs. */
+int thread_mfq_levels = MFQ_LEVELS_DEFAULT;
+const char *thread_mfq_slices;
+static struct mfq_policy mfq;
+static struct softirq_work aging_work;
+
+/* Start of a new CPU group period, deferred from the tick. */
+static struct softirq_work group_work;
+
+/* True if the 4.4BSD scheduler is in use, which computes
+   priorities itself and so does without priority donation.
+   Set by thread_init() from the chosen scheduling class. */
+bool thread_mlfqs;
+
+/* System load average for the 4.4BSD scheduler: the number of
+   threads ready to run, averaged over the past minute. */
+static fixed_t load_avg;
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
-/* List of process in sleep */
-static struct list sleep_list;
+/* Processes in sleep, keyed by the tick they wake up at, and a
+   lower bound on the earliest of those ticks. */
+static struct wheel sleep_wheel;
 static int64_t next_tick_to_wakeup = INT64_MAX;
 
 /* Idle thread. */
@@ -43,6 +78,20 @@ static struct thread *initial_thread;
 /* Lock used by allocate_tid(). */
 static struct lock tid_lock;
 
+/* Pages of dead threads, kept for reuse by thread_create() so
+   that spawning a short-lived thread does not have to go through
+   the page allocator's lock and zero a whole page.  Only the
+   struct thread at the bottom of a page needs resetting, which
+   init_thread() does anyway; the stack above it is always
+   written before it is read.  Protected by disabling
+   interrupts. */
+#define THREAD_CACHE_MAX 16
+static void *page_cache[THREAD_CACHE_MAX];
+static size_t page_cache_cnt;
+
+/* If true (default), recycle thread pages through page_cache. */
+bool thread_page_cache = true;
+
 /* Stack frame for kernel_thread(). */
 struct kernel_thread_frame 
   {
@@ -56,11 +105,29 @@ static long long idle_ticks;    /* # of timer ticks spent idle. */
 static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
+/* Run-queue latency histograms, one per MFQ level.  Bucket B
+   counts dispatches that waited in READY for [2^(B-1), 2^B)
+   cycles (bucket 0: less than one cycle). */
+#define LAT_BUCKETS 40
+static unsigned latency_hist[RQ_LEVELS_MAX][LAT_BUCKETS];
+
+/* Statistics of threads that have exited, summed. */
+static struct thread_stats exited_stats;
+static unsigned exited_cnt;
+
+/* Set when the running thread is being preempted, rather than
+   giving up the CPU of its own accord, so that schedule() can
+   tell the two kinds of yield apart. */
+static bool yield_preempted;
+
 /* Scheduling. */
-#define TIME_SLICE 4            /* # of timer ticks to give each thread. */
+#define MLFQS_TIME_SLICE 4      /* Time slice under -mlfqs. */
+#define MLFQS_PRI_PERIOD 4      /* Ticks between priority updates. */
+#define DONATION_DEPTH_MAX 8    /* Longest lock chain donated through. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
 static void kernel_thread (thread_func *, void *aux);
+static void periodic_thread (void *start);
 
 static void idle (void *aux UNUSED);
 static struct thread *running_thread (void);
@@ -71,11 +138,33 @@ static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static tid_t allocate_tids (int cnt);
+static struct thread *alloc_thread_page (void);
+static void free_thread_page (struct thread *);
+static void setup_thread (struct thread *, const char *name, int priority,
+                          tid_t, thread_func *, void *aux);
+static wheel_action_func wake_sleeper;
+static void preempt_on_return (void);
+static enum switch_reason switch_reason (const struct thread *cur);
+static void account_switch (struct thread *cur, struct thread *next,
+                            enum switch_reason);
+static void sched_select (void);
+static const struct sched_class *class_of (const struct thread *);
+static void ready_enqueue (struct thread *);
+static void sleep_insert (struct thread *, int64_t tick);
+static void rt_next_period (struct thread *);
+static void mfq_promote (struct thread *, int64_t now);
+static softirq_func mfq_age;
+static softirq_func group_period;
+static void unpark_threads (struct list *);
+static void mlfqs_update_load_avg (int ready_threads);
+static void mlfqs_update_priority (struct thread *, void *aux);
+static void mlfqs_update_recent_cpu (struct thread *, void *aux);
+static void set_effective_priority (struct thread *, int priority);
+static bool priority_less (const struct list_elem *,
+                           const struct list_elem *, void *aux);
 
 
-static bool thread_aging(struct thread *t); 
-static void thread_age_up(struct thread * t, void * aux);
-
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
    general and it is possible in this case only because loader.S
@@ -94,12 +183,12 @@ thread_init (void)
 {
   ASSERT (intr_get_level () == INTR_OFF);
 
-  lock_init (&tid_lock);
-  for (int i = 0; i < 5; ++i){    //우선순위에 따라 레디 큐 초기화
-    list_init (&ready_list[i]);
-  }
+  lock_init_named (&tid_lock, "tid_lock");
+  group_init ();
+  softirq_work_init (&group_work, group_period, NULL);
+  sched_select ();
   list_init (&all_list);
-  list_init (&sleep_list);
+  wheel_init (&sleep_wheel, 0);
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
@@ -131,8 +220,7 @@ void
 thread_tick (void) 
 {
   struct thread *t = thread_current ();
-  struct list_elem *e;
-  
+  bool preempt;
 
   /* Update statistics. */
   if (t == idle_thread)
@@ -143,59 +231,159 @@ thread_tick (void)
 #endif
   else
     kernel_ticks++;
+  t->stats.cpu_ticks++;
+
+  /* Let the scheduling class do its per-tick work, such as
+     aging, and ask whether T should be preempted early.  Only
+     the real-time class may preempt a real-time thread. */
+  preempt = sched->tick (t, timer_ticks ()) && t->rt.period == 0;
+  if (sched_edf_class.tick (t, timer_ticks ()))
+    preempt = true;
+
+  /* Charge T's CPU group, and stop T now if that throttles it. */
+  if (t != idle_thread && group_charge (t->group) && t->rt.period == 0)
+    preempt = true;
+  if (group_period_due (timer_ticks ()))
+    softirq_raise (&group_work, SOFTIRQ_TIMER);
 
   /* Enforce preemption. */
   // 고정된 타임슬라이스에서 각 쓰레드별 타임슬라이스로 계산한다.
-  if (++thread_ticks >= t->time_slice && thread_aging(t)){
-    intr_yield_on_return ();
-    // 각 큐에 어떤 쓰레드들이 있는지 확인하기 위하여 작성했다.
-    // 각 큐의 쓰레드의 이름, age 정보가 담겨져 있다.
-    for (int i = 0; i < 5; ++i)
-    {
-      //printf("queue : %d list size : %d\n", i, list_size(&ready_list[i]));
-      for (e = list_begin (&ready_list[i]); e != list_end (&ready_list[i]);
-          e = list_next (e)){
-           struct thread * t2 = list_entry (e, struct thread, elem);
-           //printf("queue : %d name : %s age : %d\n", i, t2->name, t2->age);
-        }
-    }
-
-  }
+  if (t != idle_thread)
+    t->slice_used++;
+  if (++thread_ticks >= t->time_slice || preempt)
+    preempt_on_return ();
 }
-// thread_tick에서 tick이 계산될때마다 모든 쓰레드를 검사한다. 
-static bool thread_aging(struct thread *t){
-  thread_foreach(&thread_age_up, t); //현재 스레드보다 우선순위가 낮은 모든 스레드들의 age를 올려주는 함수인 thread_age_up 함수를 매개힘수로 보낸다. 
-  return true;
+
+/* Makes the running thread yield when the current interrupt
+   returns, counting it as preempted.  Interrupt context only. */
+static void
+preempt_on_return (void)
+{
+  ASSERT (intr_context ());
+
+  yield_preempted = true;
+  intr_yield_on_return ();
 }
 
+/* Accounts for CNT timer ticks, numbered FIRST onward, that
+   passed while the idle thread ran with the periodic tick
+   stopped (see timer_idle_oneshot()).  Nothing else was ready,
+   so aging has nothing to do, but under -mlfqs the once-a-second
+   decay still has to happen.  Interrupts must be off. */
+void
+thread_tick_idle (int64_t first, int64_t cnt)
+{
+  int64_t t;
 
+  ASSERT (intr_get_level () == INTR_OFF);
 
-static void thread_age_up(struct thread * t, void * aux){
-    struct thread *cur = aux; //현재 스레드를 매개변수 aux로 받아서 cur에 넣는다. 
-    struct list_elem *e;
-    if(t->priority < cur->priority){ //t는 모든 리스트의 스레드를 의미한다. 모든 스레드 t와 현재 스레드의 우선순위를 비교한다.
-      ++t->age;  //현재 쓰레드 보다 낮은 우선순위를 가진 모든 쓰레드의 age를 올려준다.
-      if(t->age >= 20){ //스레드의 나이가 20이 되거나 그 보다 커지게 된다면 현재 존재하는 큐에서 정보를 지우고 우선순위와 타임슬라이스를 수정한뒤의 그 우선순위에 해당하는 큐에 list_push_back해준다.
-        for (e = list_begin (&ready_list[t->priority]); e != list_end (&ready_list[t->priority]);
-          e = list_next (e)){
-           struct thread * t2 = list_entry (e, struct thread, elem);
-            if(!strcmp(t->name,t2->name)){
-              list_remove(&t2->elem);
-            }
-        }
-        t->time_slice--;
-        t->priority++;
-        t->age = 0;
-        list_push_back (&ready_list[t->priority], &t->elem);
-      }
-    }
+  idle_ticks += cnt;
+  if (thread_mlfqs)
+    for (t = first; t < first + cnt; t++)
+      if (t % TIMER_FREQ == 0)
+        mlfqs_update_load_avg (0);
 }
+
 /* Prints thread statistics. */
 void
 thread_print_stats (void) 
 {
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
           idle_ticks, kernel_ticks, user_ticks);
+  group_print_stats ();
+}
+
+/* Prints per-thread scheduling statistics and the run-queue
+   latency histogram of each level.  Threads are snapshotted with
+   interrupts off and printed afterward, so that printing does
+   not perturb what is being reported. */
+void
+thread_print_schedstat (void)
+{
+  enum { SNAPSHOT_MAX = 64 };
+  static struct
+    {
+      tid_t tid;
+      char name[16];
+      int priority;
+      struct thread_stats stats;
+      struct thread_rt rt;
+    }
+  snap[SNAPSHOT_MAX];
+  static unsigned hist[RQ_LEVELS_MAX][LAT_BUCKETS];
+  struct thread_stats exited;
+  unsigned exited_threads;
+  size_t cnt = 0, omitted = 0, i;
+  enum intr_level old_level;
+  struct list_elem *e;
+  int level, b;
+
+  old_level = intr_disable ();
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, allelem);
+      if (cnt < SNAPSHOT_MAX)
+        {
+          snap[cnt].tid = t->tid;
+          strlcpy (snap[cnt].name, t->name, sizeof snap[cnt].name);
+          snap[cnt].priority = t->priority;
+          snap[cnt].stats = t->stats;
+          snap[cnt].rt = t->rt;
+          cnt++;
+        }
+      else
+        omitted++;
+    }
+  memcpy (hist, latency_hist, sizeof hist);
+  exited = exited_stats;
+  exited_threads = exited_cnt;
+  intr_set_level (old_level);
+
+  printf ("Schedstat: scheduler %s\n", sched->name);
+  printf ("Schedstat: %4s %-16s %3s %8s %8s %8s %12s %5s %5s %5s\n",
+          "tid", "name", "pri", "cpu", "vol", "invol", "ready-cyc",
+          "promo", "demo", "boost");
+  for (i = 0; i < cnt; i++)
+    printf ("Schedstat: %4d %-16s %3d %8lld %8u %8u %12llu %5u %5u %5u\n",
+            snap[i].tid, snap[i].name, snap[i].priority,
+            snap[i].stats.cpu_ticks, snap[i].stats.vol_switches,
+            snap[i].stats.invol_switches, snap[i].stats.ready_cycles,
+            snap[i].stats.promotions, snap[i].stats.demotions,
+            snap[i].stats.boosts);
+  if (omitted > 0)
+    printf ("Schedstat: (%zu more threads not shown)\n", omitted);
+  printf ("Schedstat: %4s %-16s %3s %8lld %8u %8u %12llu %5u %5u %5u\n",
+          "-", "exited", "-", exited.cpu_ticks, exited.vol_switches,
+          exited.invol_switches, exited.ready_cycles,
+          exited.promotions, exited.demotions, exited.boosts);
+  printf ("Schedstat: %u threads exited\n", exited_threads);
+  group_print_stats ();
+
+  for (i = 0; i < cnt; i++)
+    if (snap[i].rt.period != 0)
+      printf ("Schedstat: rt %4d %-16s period %d budget %d: %u jobs, "
+              "%u late, %u overruns, max response %lld\n",
+              snap[i].tid, snap[i].name, snap[i].rt.period,
+              snap[i].rt.budget, snap[i].rt.jobs, snap[i].rt.misses,
+              snap[i].rt.overruns, snap[i].rt.max_response);
+
+  printf ("Schedstat: run-queue latency, cycles (<= bound: count)\n");
+  for (level = RQ_LEVELS_MAX - 1; level >= 0; level--)
+    {
+      bool any = false;
+
+      for (b = 0; b < LAT_BUCKETS; b++)
+        if (hist[level][b] != 0)
+          {
+            if (!any)
+              printf ("Schedstat: level %2d:", level);
+            any = true;
+            printf (" %llu:%u", (1ULL << b) - 1, hist[level][b]);
+          }
+      if (any)
+        printf ("\n");
+    }
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -218,21 +406,101 @@ thread_create (const char *name, int priority,
                thread_func *function, void *aux) 
 {
   struct thread *t;
-  struct kernel_thread_frame *kf;
-  struct switch_entry_frame *ef;
-  struct switch_threads_frame *sf;
   tid_t tid;
 
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = alloc_thread_page ();
   if (t == NULL)
     return TID_ERROR;
 
   /* Initialize thread. */
+  tid = allocate_tid ();
+  setup_thread (t, name, priority, tid, function, aux);
+
+  /* Add to run queue. */
+  thread_unblock (t);
+
+  return tid;
+}
+
+/* Number of threads thread_create_many() sets up at a time. */
+#define CREATE_BATCH 32
+
+/* Creates CNT kernel threads named NAME with the given initial
+   PRIORITY, the Ith of which executes FUNCTION passing AUX[I] as
+   the argument, and stores their identifiers in TIDS[].  Pages
+   and tids are obtained for a whole batch of threads at a time,
+   and a batch is made ready in a single critical section.
+
+   Returns the number of threads created, which is less than CNT
+   only if memory ran out; the remaining elements of TIDS[] are
+   set to TID_ERROR.  The same caveats as for thread_create()
+   apply to ordering. */
+int
+thread_create_many (const char *name, int priority, thread_func *function,
+                    void *aux[], int cnt, tid_t tids[])
+{
+  int created = 0;
+
+  ASSERT (function != NULL);
+  ASSERT (cnt >= 0);
+
+  while (created < cnt)
+    {
+      struct thread *batch[CREATE_BATCH];
+      enum intr_level old_level;
+      int n = cnt - created < CREATE_BATCH ? cnt - created : CREATE_BATCH;
+      tid_t tid;
+      int i;
+
+      /* Take what the page cache has in one go, then fall back
+         on the page allocator. */
+      old_level = intr_disable ();
+      for (i = 0; i < n && thread_page_cache && page_cache_cnt > 0; i++)
+        batch[i] = page_cache[--page_cache_cnt];
+      intr_set_level (old_level);
+      for (; i < n; i++)
+        if ((batch[i] = alloc_thread_page ()) == NULL)
+          break;
+      n = i;
+      if (n == 0)
+        break;
+
+      tid = allocate_tids (n);
+      for (i = 0; i < n; i++)
+        {
+          setup_thread (batch[i], name, priority, tid + i, function,
+                        aux[created + i]);
+          tids[created + i] = tid + i;
+        }
+
+      old_level = intr_disable ();
+      for (i = 0; i < n; i++)
+        thread_unblock (batch[i]);
+      intr_set_level (old_level);
+      created += n;
+    }
+
+  for (; cnt > created; cnt--)
+    tids[cnt - 1] = TID_ERROR;
+  return created;
+}
+
+/* Initializes page T as a blocked thread named NAME with the
+   given PRIORITY and identifier TID, set up to execute FUNCTION
+   passing AUX as the argument once it is unblocked. */
+static void
+setup_thread (struct thread *t, const char *name, int priority, tid_t tid,
+              thread_func *function, void *aux)
+{
+  struct kernel_thread_frame *kf;
+  struct switch_entry_frame *ef;
+  struct switch_threads_frame *sf;
+
   init_thread (t, name, priority);
-  tid = t->tid = allocate_tid ();
+  t->tid = tid;
 
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame (t, sizeof *kf);
@@ -248,13 +516,148 @@ thread_create (const char *name, int priority,
   sf = alloc_frame (t, sizeof *sf);
   sf->eip = switch_entry;
   sf->ebp = 0;
+}
 
-  /* Add to run queue. */
-  thread_unblock (t);
+/* Returns a page for a new thread, from the page cache if it has
+   one, or a null pointer if no memory is available. */
+static struct thread *
+alloc_thread_page (void)
+{
+  enum intr_level old_level;
+  struct thread *t = NULL;
+
+  if (!thread_page_cache)
+    return palloc_get_page (PAL_ZERO);
+
+  old_level = intr_disable ();
+  if (page_cache_cnt > 0)
+    t = page_cache[--page_cache_cnt];
+  intr_set_level (old_level);
+
+  /* init_thread() clears the struct thread, and nothing else
+     needs to be zero. */
+  return t != NULL ? t : palloc_get_page (0);
+}
+
+/* Releases the page of T, a dead thread, into the page cache,
+   or back to the page allocator if the cache is full.  Clears
+   T's magic number so that stale pointers to T are caught.
+   Interrupts must be off. */
+static void
+free_thread_page (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
 
+  t->magic = 0;
+  if (thread_page_cache && page_cache_cnt < THREAD_CACHE_MAX)
+    page_cache[page_cache_cnt++] = t;
+  else
+    palloc_free_page (t);
+}
+
+/* Arguments handed from thread_create_periodic() to the new
+   thread, which copies them before letting its creator go. */
+struct periodic_start
+  {
+    thread_func *function;
+    void *aux;
+    int period;
+    int budget;
+    struct semaphore started;
+  };
+
+/* Creates a periodic real-time thread named NAME that calls
+   FUNCTION with AUX once every PERIOD ticks, starting now.  Each
+   call must return by the start of the next period and may use
+   at most BUDGET ticks of CPU time; a call that runs out of
+   budget is suspended until the next period begins.
+
+   Real-time threads are scheduled earliest-deadline-first ahead
+   of all other threads.  Returns TID_ERROR if the thread cannot
+   be created, or if admitting it would reserve more CPU time
+   than sched-edf.c allows in total. */
+tid_t
+thread_create_periodic (const char *name, int period, int budget,
+                        thread_func *function, void *aux)
+{
+  struct periodic_start start;
+  tid_t tid;
+
+  ASSERT (function != NULL);
+
+  if (!edf_admit (period, budget))
+    return TID_ERROR;
+
+  start.function = function;
+  start.aux = aux;
+  start.period = period;
+  start.budget = budget;
+  sema_init (&start.started, 0);
+  tid = thread_create (name, PRI_DEFAULT, periodic_thread, &start);
+  if (tid == TID_ERROR)
+    edf_release (period, budget);
+  else
+    sema_down (&start.started);
   return tid;
 }
 
+/* Body of a thread created by thread_create_periodic(). */
+static void
+periodic_thread (void *start_)
+{
+  struct periodic_start *start = start_;
+  thread_func *function = start->function;
+  void *aux = start->aux;
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  /* Become a real-time thread.  We are running, hence in no
+     ready set, so we may switch classes. */
+  old_level = intr_disable ();
+  cur->rt.period = start->period;
+  cur->rt.budget = cur->rt.budget_left = start->budget;
+  cur->rt.release = timer_ticks ();
+  cur->rt.deadline = cur->rt.release + cur->rt.period;
+  cur->time_slice = cur->rt.budget;
+  intr_set_level (old_level);
+  sema_up (&start->started);
+
+  for (;;)
+    {
+      /* A job that runs out of budget is moved on to the next
+         period while it runs (see thread_yield()), so note when
+         it was released and due before it starts. */
+      int64_t release = cur->rt.release;
+      int64_t deadline = cur->rt.deadline;
+      int64_t now;
+
+      function (aux);
+
+      old_level = intr_disable ();
+      now = timer_ticks ();
+      cur->rt.jobs++;
+      if (now > deadline)
+        cur->rt.misses++;
+      if (now - release > cur->rt.max_response)
+        cur->rt.max_response = now - release;
+
+      rt_next_period (cur);
+      if (cur->rt.release > now)
+        thread_sleep (cur->rt.release);
+      intr_set_level (old_level);
+    }
+}
+
+/* Moves real-time thread T on to its next period, with a fresh
+   budget. */
+static void
+rt_next_period (struct thread *t)
+{
+  t->rt.release += t->rt.period;
+  t->rt.deadline = t->rt.release + t->rt.period;
+  t->rt.budget_left = t->rt.budget;
+}
+
 /* Puts the current thread to sleep.  It will not be scheduled
    again until awoken by thread_unblock().
 
@@ -289,7 +692,8 @@ thread_unblock (struct thread *t)
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
 
-  list_push_back (&ready_list[t->priority], &t->elem); //각 우선순위별로 나눠서 큐에 저장한다.
+  class_of (t)->wake (t);
+  ready_enqueue (t); //스케줄링 클래스의 준비 큐에 저장한다.
   t->status = THREAD_READY;
   intr_set_level (old_level);
 }
@@ -304,10 +708,12 @@ update_next_tick_to_wakeup (int64_t tick)
 int64_t
 get_next_tick_to_wakeup (void)
 {
-  return next_tick_to_wakeup;
+  int64_t release = group_next_release ();
+
+  return next_tick_to_wakeup < release ? next_tick_to_wakeup : release;
 }
 
-/* Wakes up this thread after ticks */
+/* Puts the current thread to sleep until timer tick TICK. */
 void
 thread_sleep (int64_t tick)
 {
@@ -319,36 +725,47 @@ thread_sleep (int64_t tick)
 
   ASSERT (cur != idle_thread);
 
-  update_next_tick_to_wakeup (cur->wakeup_tick = tick);
-  list_push_back (&sleep_list, &cur->elem);
-
+  sleep_insert (cur, tick);
   thread_block ();
 
   intr_set_level (old_level);
 }
 
+/* Files T, which is about to block, to be woken up at timer tick
+   TICK.  Interrupts must be off. */
+static void
+sleep_insert (struct thread *t, int64_t tick)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  /* The wheel is only advanced when something may be due, so
+     bring it up to date before filing TICK relative to it. */
+  wheel_advance (&sleep_wheel, timer_ticks (), wake_sleeper, NULL);
+  wheel_insert (&sleep_wheel, &t->sleep_elem, tick);
+  update_next_tick_to_wakeup (tick);
+}
+
+/* Wakes up every sleeping thread whose wakeup tick is at or
+   before CURRENT_TICK.  Called from the timer interrupt once
+   get_next_tick_to_wakeup() has been reached. */
 void
 thread_wakeup (int64_t current_tick)
 {
-  struct list_elem *e;
-
-  next_tick_to_wakeup = INT64_MAX;
+  wheel_advance (&sleep_wheel, current_tick, wake_sleeper, NULL);
+  next_tick_to_wakeup = wheel_next_expiry (&sleep_wheel);
+
+  /* A real-time job released just now may not wait for the next
+     tick.  (When softirqd runs this instead, it yields soon
+     anyway.) */
+  if (intr_context () && edf_preempts (thread_current ()))
+    preempt_on_return ();
+}
 
-  e = list_begin (&sleep_list);
-  while (e != list_end (&sleep_list))
-    {
-      struct thread *t = list_entry (e, struct thread, elem);
-      if (current_tick >= t->wakeup_tick)
-        {
-          e = list_remove (&t->elem);
-          thread_unblock (t);
-        }
-      else
-        {
-          e = list_next (e);
-          update_next_tick_to_wakeup (t->wakeup_tick);
-        }
-    }
+/* Wheel action that wakes up the thread owning sleep element E. */
+static void
+wake_sleeper (struct wheel_elem *e, void *aux UNUSED)
+{
+  thread_unblock (wheel_entry (e, struct thread, sleep_elem));
 }
 
 /* Returns the name of the running thread. */
@@ -398,7 +815,10 @@ thread_exit (void)
      and schedule another process.  That process will destroy us
      when it calls thread_schedule_tail(). */
   intr_disable ();
+  if (thread_current ()->rt.period != 0)
+    edf_release (thread_current ()->rt.period, thread_current ()->rt.budget);
   list_remove (&thread_current()->allelem);
+  thread_current ()->group->thread_cnt--;
   thread_current ()->status = THREAD_DYING;
   schedule ();
   NOT_REACHED ();
@@ -414,17 +834,27 @@ thread_yield (void)
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
-  if (cur != idle_thread){
-    cur->priority--; //현재 스레드가 다음 스레드에게 선점 당하면 우선순위를 한단계 낮추고 그에 맞게 타임 슬라이스도 올려준다.
-    cur->time_slice++;
-    if(cur->priority < 0){ //우선순위가 0보다 작아지면 0으로 유지한다. 
-      cur->priority = 0;
-      cur->time_slice = 6;
+  if (cur->rt.throttled)
+    {
+      /* Out of budget: sit out the rest of the period, unless
+         the job is so late that the next one is already due. */
+      cur->rt.throttled = false;
+      cur->rt.overruns++;
+      rt_next_period (cur);
+      if (cur->rt.release > timer_ticks ())
+        {
+          sleep_insert (cur, cur->rt.release);
+          cur->status = THREAD_BLOCKED;
+          schedule ();
+          intr_set_level (old_level);
+          return;
+        }
+    }
+  if (cur != idle_thread)
+    {
+      class_of (cur)->yield (cur);
+      ready_enqueue (cur);
     }
-    list_remove(&cur->elem); //현재 스레드를 기존 우선순위 큐에서 삭제한다. 
-    list_push_back (&ready_list[cur->priority], &cur->elem);  
-    // 현재 쓰레드가 타임슬라이스로 다른 쓰레드로 넘어갈때 현재 쓰레드의 우선순위를 낮추고 낮춰진 우선순위에 해당하는 큐 맨 뒤에 저장한다.
-  }
   cur->status = THREAD_READY;
   schedule ();
   intr_set_level (old_level);
@@ -447,51 +877,185 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
-/* Sets the current thread's priority to NEW_PRIORITY. */
+/* Sets the current thread's priority to NEW_PRIORITY.  Ignored
+   under -mlfqs, where priorities are computed. */
 void
 thread_set_priority (int new_priority) 
 {
-  thread_current ()->priority = new_priority;
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  if (thread_mlfqs)
+    return;
+
+  old_level = intr_disable ();
+  cur->base_priority = new_priority;
+  thread_refresh_priority (cur);
+  intr_set_level (old_level);
 }
 
-/* Returns the current thread's priority. */
+/* Returns the current thread's priority, including any
+   priority donated to it. */
 int
 thread_get_priority (void) 
 {
   return thread_current ()->priority;
 }
 
-/* Sets the current thread's nice value to NICE. */
+/* Donates DONOR's priority along the chain of locks it is about
+   to wait for.  DONOR->wait_on_lock must already be set and
+   held by some thread.  The holder records DONOR as a donor;
+   then every holder along the chain, up to DONATION_DEPTH_MAX
+   links, is raised to DONOR's priority if it is lower.
+   Interrupts must be off. */
 void
-thread_set_nice (int nice UNUSED) 
+thread_donate_priority (struct thread *donor)
 {
-  /* Not yet implemented. */
+  int priority = donor->priority;
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (donor->wait_on_lock != NULL);
+  ASSERT (lock_holder (donor->wait_on_lock) != NULL);
+
+  list_push_back (&lock_holder (donor->wait_on_lock)->donors,
+                  &donor->donor_elem);
+
+  for (depth = 0; depth < DONATION_DEPTH_MAX
+                  && donor->wait_on_lock != NULL; depth++)
+    {
+      struct thread *holder = lock_holder (donor->wait_on_lock);
+      if (holder == NULL || holder->priority >= priority)
+        break;
+      set_effective_priority (holder, priority);
+      donor = holder;
+    }
+}
+
+/* Drops the donations the running thread received from threads
+   waiting for LOCK, which it is releasing, and recomputes its
+   priority from whatever donations remain.  Interrupts must be
+   off. */
+void
+thread_remove_donations (struct lock *lock)
+{
+  struct thread *cur = thread_current ();
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&cur->donors); e != list_end (&cur->donors); )
+    {
+      struct thread *donor = list_entry (e, struct thread, donor_elem);
+      if (donor->wait_on_lock == lock)
+        e = list_remove (e);
+      else
+        e = list_next (e);
+    }
+  thread_refresh_priority (cur);
+}
+
+/* Recomputes T's effective priority as the larger of its base
+   priority and the priorities of its donors.  Interrupts must be
+   off. */
+void
+thread_refresh_priority (struct thread *t)
+{
+  int priority = t->base_priority;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!list_empty (&t->donors))
+    {
+      struct thread *top = list_entry (list_max (&t->donors,
+                                                 priority_less, NULL),
+                                       struct thread, donor_elem);
+      if (top->priority > priority)
+        priority = top->priority;
+    }
+  set_effective_priority (t, priority);
+}
+
+/* Returns true if the thread owning list element A (through its
+   `donor_elem') has lower priority than the one owning B. */
+static bool
+priority_less (const struct list_elem *a, const struct list_elem *b,
+               void *aux UNUSED)
+{
+  return list_entry (a, struct thread, donor_elem)->priority
+         < list_entry (b, struct thread, donor_elem)->priority;
+}
+
+/* Sets T's effective priority to PRIORITY, requeuing T if it is
+   ready so that the scheduling class sees the change. */
+static void
+set_effective_priority (struct thread *t, int priority)
+{
+  if (priority == t->priority)
+    return;
+  if (t->status == THREAD_READY)
+    {
+      class_of (t)->dequeue (t);
+      t->priority = priority;
+      class_of (t)->enqueue (t);
+    }
+  else
+    t->priority = priority;
+}
+
+/* Sets the current thread's nice value to NICE, recomputes its
+   priority, and yields if it is no longer the highest-priority
+   thread. */
+void
+thread_set_nice (int nice) 
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  if (nice < NICE_MIN)
+    nice = NICE_MIN;
+  else if (nice > NICE_MAX)
+    nice = NICE_MAX;
+
+  old_level = intr_disable ();
+  cur->nice = nice;
+  if (thread_mlfqs)
+    {
+      mlfqs_update_priority (cur, NULL);
+      if (rq_highest (&ready_queue) > cur->priority)
+        thread_yield ();
+    }
+  intr_set_level (old_level);
 }
 
 /* Returns the current thread's nice value. */
 int
 thread_get_nice (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  return thread_current ()->nice;
 }
 
 /* Returns 100 times the system load average. */
 int
 thread_get_load_avg (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int load = fp_to_int_round (fp_mul_int (load_avg, 100));
+  intr_set_level (old_level);
+  return load;
 }
 
 /* Returns 100 times the current thread's recent_cpu value. */
 int
 thread_get_recent_cpu (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int recent = fp_to_int_round (fp_mul_int (thread_current ()->recent_cpu,
+                                            100));
+  intr_set_level (old_level);
+  return recent;
 }
-
+
 /* Idle thread.  Executes when no other thread is ready to run.
 
    The idle thread is initially put on the ready list by
@@ -525,8 +1089,13 @@ idle (void *idle_started_ UNUSED)
          time.
 
          See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
-         7.11.1 "HLT Instruction". */
-      asm volatile ("sti; hlt" : : : "memory");
+         7.11.1 "HLT Instruction".
+
+         In dynamic-tick mode timer_idle_oneshot() does this
+         itself, after arranging for the next interrupt to come
+         no sooner than the next sleeper is due. */
+      if (!timer_idle_oneshot ())
+        asm volatile ("sti; hlt" : : : "memory");
     }
 }
 
@@ -567,6 +1136,7 @@ is_thread (struct thread *t)
 static void
 init_thread (struct thread *t, const char *name, int priority)
 {
+  struct thread *parent = running_thread ();
   enum intr_level old_level;
 
   ASSERT (t != NULL);
@@ -577,30 +1147,29 @@ init_thread (struct thread *t, const char *name, int priority)
   t->status = THREAD_BLOCKED;
   strlcpy (t->name, name, sizeof t->name);
   t->stack = (uint8_t *) t + PGSIZE;
-  t->priority = priority;
-  t->age = 0; //기본 age는 0으로 설정해준다.
+  t->priority = t->base_priority = priority;
+  list_init (&t->donors);
   t->magic = THREAD_MAGIC;
 
-  // 우선순위별로 time_slice를 준다.
-  switch(t->priority){
-    case 0:
-    t->time_slice = 6;
-    break;
-    case 1:
-    t->time_slice = 5;
-    break;
-    case 2:
-    t->time_slice = 4;
-    break;
-    case 3:
-    t->time_slice = 3;
-    break;
-    case 4:
-    t->time_slice = 2;
-    break;
-  }
+  /* The initial thread is its own "parent" here, already cleared
+     above, so it starts out in the root group. */
+  if (parent == t || !is_thread (parent))
+    parent = NULL;
+  t->group = parent != NULL ? parent->group : &group_root;
+  if (thread_mlfqs)
+    {
+      /* Inherit the creator's niceness and CPU history, then let
+         them decide T's priority instead of PRIORITY. */
+      if (parent != NULL)
+        {
+          t->nice = parent->nice;
+          t->recent_cpu = parent->recent_cpu;
+        }
+      mlfqs_update_priority (t, NULL);
+    }
   old_level = intr_disable ();
   list_push_back (&all_list, &t->allelem);
+  t->group->thread_cnt++;
   intr_set_level (old_level);
 }
 
@@ -625,33 +1194,30 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void) 
 {
-  // 다음 쓰레드를 선택할때 우선순위별로 list를 검사하여서 그 list의 쓰레드를 넘겨준다.
-  if (list_empty (&ready_list[4])){ //우선순위가 가장 높은 4번 리스트를 먼저 검사하고 비어있으면 바로 밑 우선순위위 리스트를 검사한다. 
-    if (list_empty (&ready_list[3])){
-      if (list_empty (&ready_list[2])){
-        if (list_empty (&ready_list[1])){
-          if (list_empty (&ready_list[0])){ //마지막 우선순위인 0번 리스트가 비어있으면 idle_thread를 반환한다.
+  for (;;)
+    {
+      struct thread *t = sched_edf_class.pick_next ();
+      struct list released;
+
+      if (t == NULL)
+        t = sched->pick_next ();
+      if (t == NULL)
+        {
+          /* Rather than idle, let groups run past their shares. */
+          list_init (&released);
+          if (!group_waive_shares (&released))
             return idle_thread;
-          }
-          else{ //리스트가 비어 있지 않다면 해당 리스트의 스레드를 반환한다. 
-            return list_entry (list_pop_front (&ready_list[0]), struct thread, elem);
-          }
+          unpark_threads (&released);
         }
-        else{
-          return list_entry (list_pop_front (&ready_list[1]), struct thread, elem);
+      else if (t->rt.period != 0 || !group_throttled (t->group))
+        return t;
+      else
+        {
+          /* T's group is throttled: park T until it is released. */
+          t->status = THREAD_BLOCKED;
+          group_park (t);
         }
-      }
-      else{
-        return list_entry (list_pop_front (&ready_list[2]), struct thread, elem);
-      }
-    }
-    else{
-      return list_entry (list_pop_front (&ready_list[3]), struct thread, elem);
     }
-  }
-  else{
-    return list_entry (list_pop_front (&ready_list[4]), struct thread, elem);
-  }
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -696,7 +1262,7 @@ thread_schedule_tail (struct thread *prev)
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+      free_thread_page (prev);
     }
 }
 
@@ -711,6 +1277,7 @@ static void
 schedule (void) 
 {
   struct thread *cur = running_thread ();
+  enum switch_reason reason = switch_reason (cur);
   struct thread *next = next_thread_to_run ();
   struct thread *prev = NULL;
 
@@ -718,20 +1285,473 @@ schedule (void)
   ASSERT (cur->status != THREAD_RUNNING);
   ASSERT (is_thread (next));
 
+  account_switch (cur, next, reason);
+  schedtrace_record (cur, next, reason);
   if (cur != next)
     prev = switch_threads (cur, next);
   thread_schedule_tail (prev);
 }
 
+/* Makes T, which has just become ready to run, known to the
+   scheduling class, starting its aging and latency clocks.
+   Interrupts must be off. */
+static void
+ready_enqueue (struct thread *t)
+{
+  t->ready_tick = timer_ticks ();
+  t->stats.enqueue_tsc = tsc_read ();
+  class_of (t)->enqueue (t);
+}
+
+/* Makes the threads in RELEASED, which were parked by their CPU
+   groups, ready to run again.  Interrupts must be off. */
+static void
+unpark_threads (struct list *released)
+{
+  while (!list_empty (released))
+    {
+      struct thread *t = list_entry (list_pop_front (released),
+                                     struct thread, elem);
+      ASSERT (t->status == THREAD_BLOCKED);
+      t->status = THREAD_READY;
+      ready_enqueue (t);
+    }
+}
+
+/* Starts a new CPU group period, releasing throttled groups. */
+static void
+group_period (void *aux UNUSED)
+{
+  struct list released;
+  enum intr_level old_level = intr_disable ();
+
+  list_init (&released);
+  group_new_period (timer_ticks (), &released);
+  unpark_threads (&released);
+  intr_set_level (old_level);
+}
+
+/* Moves the running thread to CPU group G.  Threads it creates
+   from now on start out in G too. */
+void
+thread_set_group (struct thread_group *g)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (g != NULL);
+
+  old_level = intr_disable ();
+  cur->group->thread_cnt--;
+  cur->group = g;
+  g->thread_cnt++;
+  intr_set_level (old_level);
+}
+
+/* Returns the scheduling class T belongs to. */
+static const struct sched_class *
+class_of (const struct thread *t)
+{
+  return t->rt.period != 0 ? &sched_edf_class : sched;
+}
+
+/* Multilevel feedback queue scheduling class, the default. */
+
+/* Sets up the policy from -mfq and -slices.  The rules
+   themselves, shared with the host-side simulator, are in
+   mfq-policy.c. */
+static void
+mfq_init (void)
+{
+  int bad_level;
+
+  if (thread_mfq_levels < 1 || thread_mfq_levels > RQ_LEVELS_MAX)
+    PANIC ("-mfq=%d: number of levels must be between 1 and %d",
+           thread_mfq_levels, RQ_LEVELS_MAX);
+  softirq_work_init (&aging_work, mfq_age, NULL);
+
+  rq_init (&ready_queue);
+  bad_level = mfq_policy_init (&mfq, thread_mfq_levels, thread_mfq_slices);
+  if (bad_level >= 0)
+    PANIC ("-slices: time slice of level %d must be positive", bad_level);
+}
+
+/* Appends T to the tail of the ready queue for its priority and
+   gives it what is left of that level's time slice. */
+static void
+mfq_enqueue (struct thread *t)
+{
+  t->time_slice = mfq_slice_left (&mfq, t->priority, t->slice_used);
+  rq_push_back (&ready_queue, &t->elem, t->priority);
+}
+
+/* Removes T from the ready queue. */
+static void
+mfq_dequeue (struct thread *t)
+{
+  rq_remove (&ready_queue, &t->elem, t->priority);
+}
+
+/* Pops the head of the highest non-empty level. */
+static struct thread *
+mfq_pop (void)
+{
+  struct list_elem *e = rq_pop_highest (&ready_queue, NULL);
+
+  return e != NULL ? list_entry (e, struct thread, elem) : NULL;
+}
+
+/* Pops the next thread, handing out any promotions it earned
+   while it waited deeper in its queue than the aging sweep
+   looks. */
+static struct thread *
+mfq_pick_next (void)
+{
+  struct thread *t = mfq_pop ();
+
+  if (t != NULL)
+    mfq_promote (t, timer_ticks ());
+  return t;
+}
+
+/* Raises the priority of T, which has been waiting in the ready
+   queue since T->ready_tick, by the levels it has earned by
+   aging as of NOW, and restarts its aging clock if it moved.  T
+   must not be in the ready queue. */
+static void
+mfq_promote (struct thread *t, int64_t now)
+{
+  int earned = mfq_promotions_earned (&mfq, t->base_priority,
+                                      t->ready_tick, now);
+
+  if (earned == 0)
+    return;
+
+  t->base_priority += earned;
+  t->stats.promotions += earned;
+  if (t->priority < t->base_priority)
+    t->priority = t->base_priority;
+  t->slice_used = 0;
+  t->time_slice = mfq.slice[t->priority];
+  t->ready_tick = now;
+}
+
+/* Ages the ready queue as of NOW.
+
+   Every level is a FIFO filled in enqueue order, so the thread at
+   its head has waited longest.  Looking only at the heads, and
+   promoting at most MFQ_AGING_BATCH threads per level, bounds the
+   work done here by the number of levels regardless of how many
+   threads exist.  Threads further back that are overdue are
+   promoted by mfq_pick_next() or by a later sweep. */
+static void
+mfq_age_sweep (int64_t now)
+{
+  int level;
+
+  for (level = PRI_MAX - 1; level >= PRI_MIN; level--)
+    {
+      struct list *queue = rq_level (&ready_queue, level);
+      int batch;
+
+      for (batch = 0; batch < mfq.aging_batch && !list_empty (queue);
+           batch++)
+        {
+          struct thread *t = list_entry (list_front (queue),
+                                         struct thread, elem);
+          if (!mfq_aging_due (&mfq, t->ready_tick, now))
+            break;
+
+          rq_remove (&ready_queue, &t->elem, level);
+          mfq_promote (t, now);
+          rq_push_back (&ready_queue, &t->elem, t->priority);
+        }
+    }
+}
+
+/* Deferred aging, run after the timer interrupt returns. */
+static void
+mfq_age (void *aux UNUSED)
+{
+  enum intr_level old_level = intr_disable ();
+  mfq_age_sweep (timer_ticks ());
+  intr_set_level (old_level);
+}
+
+/* Leaves aging to run after the interrupt, with interrupts on. */
+static bool
+mfq_tick (struct thread *cur UNUSED, int64_t now UNUSED)
+{
+  softirq_raise (&aging_work, SOFTIRQ_TIMER);
+  return false;
+}
+
+/* Demotes CUR one level, but never below a priority donated to
+   it, if it has used up its level's time slice.  A thread that
+   gives up the CPU early, because it yielded or was preempted by
+   a higher-priority thread, keeps its level and the rest of its
+   slice. */
+static void
+mfq_yield (struct thread *cur)
+{
+  int base;
+
+  if (!mfq_slice_spent (&mfq, cur->priority, cur->slice_used))
+    return;
+  cur->slice_used = 0;
+  base = mfq_demoted_level (&mfq, cur->base_priority);
+  if (base != cur->base_priority){ //타임 슬라이스를 다 쓴 스레드만 우선순위를 한단계 낮추고 그에 맞게 타임 슬라이스도 올려준다.
+    cur->base_priority = base;     //우선순위가 가장 낮은 큐에 있으면 그대로 유지한다.
+    cur->stats.demotions++;
+  }
+  thread_refresh_priority (cur);    //기부받은 우선순위가 있으면 그보다 낮아지지 않는다.
+}
+
+/* Raises T one level for waking up, from timer_sleep() or a
+   semaphore, if the policy says it has been interactive, so
+   that threads that mostly wait are picked ahead of CPU hogs.
+   Newly created threads, which have never blocked, are not
+   boosted. */
+static void
+mfq_wake (struct thread *t)
+{
+  if (t->stats.vol_switches == 0
+      || !mfq_wants_boost (&mfq, t->priority, t->base_priority,
+                           t->slice_used))
+    return;
+  t->base_priority++;
+  t->stats.boosts++;
+  thread_refresh_priority (t);
+}
+
+static const struct sched_class mfq_class =
+  {
+    "mfq",
+    mfq_init,
+    mfq_enqueue,
+    mfq_dequeue,
+    mfq_pick_next,
+    mfq_tick,
+    mfq_yield,
+    mfq_wake,
+  };
+
+/* 4.4BSD scheduling class.  Shares the MFQ's ready queue, with 64
+   levels and a fixed slice, but computes priorities from
+   recent_cpu and nice instead of aging and demoting. */
+
+static void
+mlfqs_init (void)
+{
+  int level;
+
+  thread_mfq_levels = RQ_LEVELS_MAX;
+  thread_mfq_slices = NULL;
+  mfq_policy_init (&mfq, thread_mfq_levels, NULL);
+  for (level = 0; level < thread_mfq_levels; level++)
+    mfq.slice[level] = MLFQS_TIME_SLICE;
+  rq_init (&ready_queue);
+}
+
+/* Per-tick bookkeeping of the 4.4BSD scheduler, with CUR the
+   running thread and NOW the current tick.  Charges the tick to
+   CUR, recomputes load_avg and every recent_cpu once a second,
+   and every priority each MLFQS_PRI_PERIOD ticks, preempting CUR
+   if it is no longer the highest. */
+static bool
+mlfqs_tick (struct thread *cur, int64_t now)
+{
+  if (cur != idle_thread)
+    cur->recent_cpu = fp_add_int (cur->recent_cpu, 1);
+
+  if (now % TIMER_FREQ == 0)
+    mlfqs_update_load_avg (rq_size (&ready_queue)
+                           + (cur != idle_thread ? 1 : 0));
+
+  if (now % MLFQS_PRI_PERIOD == 0)
+    {
+      thread_foreach (mlfqs_update_priority, NULL);
+      return rq_highest (&ready_queue) > cur->priority;
+    }
+  return false;
+}
+
+/* The 4.4BSD scheduler gives every run a whole slice. */
+static void
+mlfqs_yield (struct thread *cur)
+{
+  cur->slice_used = 0;
+}
+
+static void
+mlfqs_wake (struct thread *t)
+{
+  t->slice_used = 0;
+}
+
+static const struct sched_class mlfqs_class =
+  {
+    "mlfqs",
+    mlfqs_init,
+    mfq_enqueue,
+    mfq_dequeue,
+    mfq_pop,
+    mlfqs_tick,
+    mlfqs_yield,
+    mlfqs_wake,
+  };
+
+/* Selectable scheduling classes. */
+static const struct sched_class *const sched_classes[] =
+  {
+    &mfq_class,
+    &mlfqs_class,
+    &sched_stride_class,
+    &sched_lottery_class,
+    NULL,
+  };
+
+/* Picks the scheduling class named by thread_sched_name and
+   initializes it. */
+static void
+sched_select (void)
+{
+  const char *name = thread_sched_name != NULL ? thread_sched_name : "mfq";
+  const struct sched_class *const *c;
+
+  for (c = sched_classes; *c != NULL; c++)
+    if (!strcmp ((*c)->name, name))
+      break;
+  if (*c == NULL)
+    PANIC ("-sched=%s: unknown scheduler", name);
+
+  sched = *c;
+  thread_sched_name = sched->name;
+  thread_mlfqs = sched == &mlfqs_class;
+  sched->init ();
+  sched_edf_class.init ();
+}
+
+/* Once-a-second update of the 4.4BSD scheduler, with
+   READY_THREADS threads running or ready to run:
+   load_avg = (59/60)*load_avg + (1/60)*ready_threads, then every
+   recent_cpu decays by the new load average. */
+static void
+mlfqs_update_load_avg (int ready_threads)
+{
+  load_avg = fp_add (fp_div_int (fp_mul_int (load_avg, 59), 60),
+                     fp_div_int (fp_from_int (ready_threads), 60));
+  thread_foreach (mlfqs_update_recent_cpu, NULL);
+}
+
+/* Decays T's recent_cpu by the current load average:
+   recent_cpu = (2*load_avg)/(2*load_avg + 1) * recent_cpu + nice. */
+static void
+mlfqs_update_recent_cpu (struct thread *t, void *aux UNUSED)
+{
+  fixed_t twice_load = fp_mul_int (load_avg, 2);
+  fixed_t coeff = fp_div (twice_load, fp_add_int (twice_load, 1));
+
+  if (t == idle_thread)
+    return;
+  t->recent_cpu = fp_add_int (fp_mul (coeff, t->recent_cpu), t->nice);
+}
+
+/* Recomputes T's priority as
+   PRI_MAX - recent_cpu/4 - nice*2, clamped to the valid range,
+   and moves T to its new level if it is in the ready queue. */
+static void
+mlfqs_update_priority (struct thread *t, void *aux UNUSED)
+{
+  int priority;
+
+  if (t == idle_thread)
+    return;
+
+  priority = PRI_MAX - fp_to_int_trunc (fp_div_int (t->recent_cpu, 4))
+             - t->nice * 2;
+  if (priority < PRI_MIN)
+    priority = PRI_MIN;
+  else if (priority > PRI_MAX)
+    priority = PRI_MAX;
+
+  t->base_priority = priority;
+  set_effective_priority (t, priority);
+}
+
+/* Returns why CUR, which is about to be switched away from,
+   stopped running. */
+static enum switch_reason
+switch_reason (const struct thread *cur)
+{
+  bool preempted = yield_preempted;
+
+  yield_preempted = false;
+  switch (cur->status)
+    {
+    case THREAD_DYING:
+      return SWITCH_EXIT;
+    case THREAD_READY:
+      return preempted ? SWITCH_PREEMPT : SWITCH_YIELD;
+    default:
+      return SWITCH_BLOCK;
+    }
+}
+
+/* Updates scheduling statistics for a switch from CUR, which
+   stopped running for REASON, to NEXT, which was just taken off
+   the ready queue. */
+static void
+account_switch (struct thread *cur, struct thread *next,
+                enum switch_reason reason)
+{
+  if (reason == SWITCH_EXIT)
+    {
+      exited_stats.cpu_ticks += cur->stats.cpu_ticks;
+      exited_stats.vol_switches += cur->stats.vol_switches;
+      exited_stats.invol_switches += cur->stats.invol_switches;
+      exited_stats.ready_cycles += cur->stats.ready_cycles;
+      exited_stats.promotions += cur->stats.promotions;
+      exited_stats.demotions += cur->stats.demotions;
+      exited_stats.boosts += cur->stats.boosts;
+      exited_cnt++;
+    }
+  else if (reason == SWITCH_PREEMPT)
+    cur->stats.invol_switches++;
+  else
+    cur->stats.vol_switches++;
+
+  if (next != idle_thread && next->stats.enqueue_tsc != 0)
+    {
+      uint64_t waited = tsc_read () - next->stats.enqueue_tsc;
+      uint32_t hi = waited >> 32, lo = waited;
+      int bucket = hi != 0 ? 64 - __builtin_clz (hi)
+                   : lo != 0 ? 32 - __builtin_clz (lo) : 0;
+
+      next->stats.ready_cycles += waited;
+      next->stats.enqueue_tsc = 0;
+      latency_hist[next->priority][bucket < LAT_BUCKETS
+                                   ? bucket : LAT_BUCKETS - 1]++;
+    }
+}
+
 /* Returns a tid to use for a new thread. */
 static tid_t
 allocate_tid (void) 
+{
+  return allocate_tids (1);
+}
+
+/* Returns the first of CNT consecutive tids for new threads. */
+static tid_t
+allocate_tids (int cnt) 
 {
   static tid_t next_tid = 1;
   tid_t tid;
 
   lock_acquire (&tid_lock);
-  tid = next_tid++;
+  tid = next_tid;
+  next_tid += cnt;
   lock_release (&tid_lock);
 
   return tid;
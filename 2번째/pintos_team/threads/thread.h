@@ -4,6 +4,9 @@
 #include <debug.h>
 #include <list.h>
 #include <stdint.h>
+#include <wheel.h>
+#include "threads/fixed-point.h"
+#include "threads/mfq-policy.h"
 
 /* States in a thread's life cycle. */
 enum thread_status
@@ -19,10 +22,54 @@ enum thread_status
 typedef int tid_t;
 #define TID_ERROR ((tid_t) -1)          /* Error value for tid_t. */
 
-/* Thread priorities. */
+/* Thread priorities.  Each priority is one level of the
+   multilevel feedback queue; the number of levels is chosen at
+   boot with -mfq=LEVELS and defaults to MFQ_LEVELS_DEFAULT, in
+   mfq-policy.h. */
 #define PRI_MIN 0                       /* Lowest priority. */
-#define PRI_DEFAULT 2                   /* Default priority. */
-#define PRI_MAX 4                       /* Highest priority. */
+#define PRI_DEFAULT (thread_mfq_levels / 2) /* Default priority. */
+#define PRI_MAX (thread_mfq_levels - 1) /* Highest priority. */
+
+/* -mfq=LEVELS: number of MFQ levels.
+   -slices=S0,S1,...: time slice of each level, lowest first. */
+extern int thread_mfq_levels;
+extern const char *thread_mfq_slices;
+
+/* Thread niceness, for the 4.4BSD scheduler. */
+#define NICE_MIN -20                    /* Nicest. */
+#define NICE_DEFAULT 0                  /* Default. */
+#define NICE_MAX 20                     /* Least nice. */
+
+struct thread_group;
+
+/* Per-thread scheduling statistics. */
+struct thread_stats
+  {
+    int64_t cpu_ticks;                  /* Timer ticks spent running. */
+    unsigned vol_switches;              /* Blocked or yielded. */
+    unsigned invol_switches;            /* Preempted by the scheduler. */
+    uint64_t ready_cycles;              /* Cycles spent in READY. */
+    uint64_t enqueue_tsc;               /* When last made READY. */
+    unsigned promotions;                /* Levels gained by aging. */
+    unsigned demotions;                 /* Levels lost for using up slices. */
+    unsigned boosts;                    /* Levels gained on wakeup. */
+  };
+
+/* Parameters and statistics of a periodic real-time thread,
+   scheduled earliest-deadline-first (see sched-edf.c). */
+struct thread_rt
+  {
+    int period;                         /* Ticks per period, 0 if not RT. */
+    int budget;                         /* CPU ticks allowed per period. */
+    int budget_left;                    /* CPU ticks left this period. */
+    int64_t release;                    /* Start of the current period. */
+    int64_t deadline;                   /* End of the current period. */
+    bool throttled;                     /* Out of budget, must wait. */
+    unsigned jobs;                      /* Jobs completed. */
+    unsigned misses;                    /* Jobs completed late. */
+    unsigned overruns;                  /* Times throttled. */
+    int64_t max_response;               /* Longest release-to-finish. */
+  };
 
 /* A kernel thread or user process.
 
@@ -87,11 +134,16 @@ struct thread
     enum thread_status status;          /* Thread state. */
     char name[16];                      /* Name (for debugging purposes). */
     uint8_t *stack;                     /* Saved stack pointer. */
-    int priority;                       /* Priority. */
+    int priority;                       /* Priority, including donations. */
+    int base_priority;                  /* Priority before donations. */
     struct list_elem allelem;           /* List element for all threads list. */
+    struct thread_group *group;         /* CPU group (see group.h). */
 
     /* Shared between thread.c and synch.c. */
     struct list_elem elem;              /* List element. */
+    struct lock *wait_on_lock;          /* Lock being waited for. */
+    struct list donors;                 /* Threads donating to us. */
+    struct list_elem donor_elem;        /* Element in a holder's donors. */
 
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
@@ -99,23 +151,60 @@ struct thread
 #endif
 
     /* For timer_sleep() */
-    int64_t wakeup_tick;
+    struct wheel_elem sleep_elem;       /* Element in the sleep wheel. */
 
     /* Owned by thread.c. */
     unsigned magic;                     /* Detects stack overflow. */
 
     unsigned time_slice;     // 타임슬라이스
-    int age;            // aging 기법을 위하여 사용
+    unsigned slice_used;                /* Ticks of this level's slice used. */
+    int64_t ready_tick; // aging 기법을 위하여 사용: 레디 큐에 들어간 시각
+
+    /* For the 4.4BSD scheduler (-mlfqs). */
+    int nice;                           /* Niceness. */
+    fixed_t recent_cpu;                 /* Recent CPU usage. */
+
+    /* For the stride scheduler (-sched=stride). */
+    int64_t pass;                       /* Virtual time consumed. */
+
+    /* For periodic threads (thread_create_periodic()). */
+    struct thread_rt rt;
+
+    /* Scheduling statistics, reported by the `schedstat' action. */
+    struct thread_stats stats;
   };
 
+/* Name of the scheduling class to use: "mfq" (default),
+   "mlfqs", "stride" or "lottery".  Controlled by kernel
+   command-line option "-sched=NAME"; "-mlfqs" is short for
+   "-sched=mlfqs".  Names the class in use once thread_init()
+   has run. */
+extern const char *thread_sched_name;
+
+/* True if the 4.4BSD multilevel feedback queue scheduler is in
+   use. */
+extern bool thread_mlfqs;
+
+/* If true (default), the pages of dead threads are kept for
+   reuse by new threads instead of being freed and zeroed. */
+extern bool thread_page_cache;
+
 void thread_init (void);
 void thread_start (void);
 
 void thread_tick (void);
+void thread_tick_idle (int64_t first, int64_t cnt);
 void thread_print_stats (void);
+void thread_print_schedstat (void);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
+tid_t thread_create_periodic (const char *name, int period, int budget,
+                              thread_func *, void *);
+int thread_create_many (const char *name, int priority, thread_func *,
+                        void *aux[], int cnt, tid_t tids[]);
+
+void thread_set_group (struct thread_group *);
 
 void thread_block (void);
 void thread_unblock (struct thread *);
@@ -138,6 +227,11 @@ void thread_foreach (thread_action_func *, void *);
 int thread_get_priority (void);
 void thread_set_priority (int);
 
+struct lock;
+void thread_donate_priority (struct thread *donor);
+void thread_remove_donations (struct lock *);
+void thread_refresh_priority (struct thread *);
+
 int thread_get_nice (void);
 void thread_set_nice (int);
 int thread_get_recent_cpu (void);
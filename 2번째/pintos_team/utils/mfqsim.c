@@ -0,0 +1,383 @@
+/* mfqsim: simulates the kernel's multilevel feedback queue
+   scheduler on the host.
+
+   The scheduling rules come from threads/mfq-policy.c and the
+   ready queue from threads/runqueue.c, compiled unchanged from
+   the kernel sources, so a change to either shows up here
+   without booting Pintos.  What is simulated around them is a
+   single CPU driven by a tick counter and a synthetic workload
+   of CPU-bound tasks, which never block, and I/O-bound tasks,
+   which run a short burst and then sleep.  Like the kernel, the
+   simulator ages the ready queue every tick, gives a thread the
+   rest of its slice when it is requeued, demotes it when it
+   gives up the CPU with its slice used up, boosts it when it
+   wakes after using little of it, and, as the MFQ does not
+   preempt on wakeup, lets the running task finish its slice
+   even when a higher-priority one wakes. */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "threads/mfq-policy.h"
+#include "threads/runqueue.h"
+
+#define TASKS_MAX 256
+
+enum task_kind
+  {
+    TASK_CPU,                   /* Always runnable. */
+    TASK_IO                     /* Runs a burst, then sleeps. */
+  };
+
+/* A simulated thread. */
+struct task
+  {
+    struct list_elem elem;      /* Ready queue element. */
+    int id;
+    enum task_kind kind;
+    int base_priority;          /* Level, without donation. */
+    unsigned time_slice;        /* Ticks it may run when picked. */
+    unsigned slice_used;        /* Ticks of its level's slice used. */
+    long long ready_tick;       /* When last made ready. */
+    int burst_left;             /* Ticks left in I/O task's burst. */
+    long long wake_tick;        /* When it is due to wake or woke. */
+    int asleep;                 /* Nonzero while sleeping. */
+    int waking;                 /* Woken but has not run since. */
+
+    /* Statistics. */
+    long long cpu_ticks;
+    long long wakeups;
+    long long latency_sum;      /* Ticks from waking to running. */
+    long long latency_max;
+    unsigned vol, invol;        /* Context switches. */
+    unsigned promotions, demotions, boosts;
+  };
+
+static struct mfq_policy policy;
+static struct runqueue rq;
+static struct task tasks[TASKS_MAX];
+static int task_cnt;
+static int io_burst = 1, io_sleep = 5;
+
+/* Called by ASSERT in the kernel sources on failure. */
+void
+debug_panic (const char *file, int line, const char *function,
+             const char *message, ...)
+{
+  fprintf (stderr, "mfqsim: %s:%d: %s(): %s\n",
+           file, line, function, message);
+  abort ();
+}
+
+static void
+usage (void)
+{
+  printf ("mfqsim, simulates the kernel's MFQ scheduler on the host\n"
+          "usage: mfqsim [OPTION...]\n"
+          "  -l LEVELS      Number of levels (default %d).\n"
+          "  -s S0,S1,...   Time slice in ticks of each level, lowest first.\n"
+          "  -a TICKS       Ready ticks that earn a promotion (default %d).\n"
+          "  -b N           Promotions per level per tick (default %d).\n"
+          "  -t TICKS       Ticks to simulate (default 1000000).\n"
+          "  -c N           CPU-bound tasks (default 4).\n"
+          "  -i N           I/O-bound tasks (default 4).\n"
+          "  -B TICKS       Burst of an I/O-bound task (default 1).\n"
+          "  -S TICKS       Mean sleep of an I/O-bound task (default 5).\n"
+          "  -r SEED        Seed for sleep lengths (default 1).\n"
+          "  -v             Print a line per task.\n"
+          "To sweep a parameter, run it in a loop, e.g.\n"
+          "  for a in 5 10 20 40; do ./mfqsim -a $a; done\n",
+          MFQ_LEVELS_DEFAULT, MFQ_AGING_THRESHOLD, MFQ_AGING_BATCH);
+  exit (EXIT_SUCCESS);
+}
+
+/* Makes T ready as of NOW, with the rest of its slice. */
+static void
+enqueue (struct task *t, long long now)
+{
+  t->time_slice = mfq_slice_left (&policy, t->base_priority, t->slice_used);
+  t->ready_tick = now;
+  rq_push_back (&rq, &t->elem, t->base_priority);
+}
+
+/* Raises T, which is not in the ready queue, by the levels it
+   has earned by aging as of NOW. */
+static void
+promote (struct task *t, long long now)
+{
+  int earned = mfq_promotions_earned (&policy, t->base_priority,
+                                      t->ready_tick, now);
+
+  if (earned == 0)
+    return;
+  t->base_priority += earned;
+  t->promotions += earned;
+  t->slice_used = 0;
+  t->time_slice = policy.slice[t->base_priority];
+  t->ready_tick = now;
+}
+
+/* Ages the ready queue as of NOW, like mfq_age_sweep(). */
+static void
+age (long long now)
+{
+  int level;
+
+  for (level = policy.levels - 2; level >= 0; level--)
+    {
+      struct list *queue = rq_level (&rq, level);
+      int batch;
+
+      for (batch = 0; batch < policy.aging_batch && !list_empty (queue);
+           batch++)
+        {
+          struct task *t = list_entry (list_front (queue), struct task, elem);
+          if (!mfq_aging_due (&policy, t->ready_tick, now))
+            break;
+
+          rq_remove (&rq, &t->elem, level);
+          promote (t, now);
+          rq_push_back (&rq, &t->elem, t->base_priority);
+        }
+    }
+}
+
+/* Gives up the CPU for CUR, which stays runnable. */
+static void
+yield (struct task *cur, long long now)
+{
+  if (mfq_slice_spent (&policy, cur->base_priority, cur->slice_used))
+    {
+      int base = mfq_demoted_level (&policy, cur->base_priority);
+
+      cur->slice_used = 0;
+      if (base != cur->base_priority)
+        {
+          cur->base_priority = base;
+          cur->demotions++;
+        }
+    }
+  enqueue (cur, now);
+}
+
+/* Wakes T, which was asleep, as of NOW. */
+static void
+wake (struct task *t, long long now)
+{
+  t->asleep = 0;
+  t->waking = 1;
+  t->wake_tick = now;
+  if (mfq_wants_boost (&policy, t->base_priority, t->base_priority,
+                       t->slice_used))
+    {
+      t->base_priority++;
+      t->boosts++;
+    }
+  enqueue (t, now);
+}
+
+/* Returns the next task to run as of NOW, or a null pointer if
+   none is ready. */
+static struct task *
+pick_next (long long now)
+{
+  struct list_elem *e = rq_pop_highest (&rq, NULL);
+  struct task *t;
+
+  if (e == NULL)
+    return NULL;
+  t = list_entry (e, struct task, elem);
+  promote (t, now);
+  if (t->waking)
+    {
+      long long latency = now - t->wake_tick;
+      t->waking = 0;
+      t->wakeups++;
+      t->latency_sum += latency;
+      if (latency > t->latency_max)
+        t->latency_max = latency;
+    }
+  return t;
+}
+
+/* Returns a sleep length with mean IO_SLEEP. */
+static int
+sleep_length (void)
+{
+  return io_sleep > 1 ? 1 + rand () % (2 * io_sleep - 1) : 1;
+}
+
+/* Prints a summary of the tasks of KIND, whose CPU share is out
+   of TICKS. */
+static void
+print_kind (const char *name, enum task_kind kind, long long ticks)
+{
+  long long cpu = 0, wakeups = 0, latency_sum = 0, latency_max = 0;
+  unsigned vol = 0, invol = 0, promotions = 0, demotions = 0, boosts = 0;
+  double level_sum = 0, sum = 0, sum_sq = 0;
+  int i, n = 0;
+
+  for (i = 0; i < task_cnt; i++)
+    {
+      struct task *t = &tasks[i];
+      if (t->kind != kind)
+        continue;
+      n++;
+      cpu += t->cpu_ticks;
+      sum += t->cpu_ticks;
+      sum_sq += (double) t->cpu_ticks * t->cpu_ticks;
+      wakeups += t->wakeups;
+      latency_sum += t->latency_sum;
+      if (t->latency_max > latency_max)
+        latency_max = t->latency_max;
+      vol += t->vol;
+      invol += t->invol;
+      promotions += t->promotions;
+      demotions += t->demotions;
+      boosts += t->boosts;
+      level_sum += t->base_priority;
+    }
+  if (n == 0)
+    return;
+
+  printf ("%-4s tasks=%d cpu=%.1f%% fair=%.3f level=%.2f vol=%u invol=%u "
+          "promo=%u demo=%u boost=%u",
+          name, n, 100.0 * cpu / ticks,
+          sum_sq > 0 ? sum * sum / (n * sum_sq) : 1.0, level_sum / n,
+          vol, invol, promotions, demotions, boosts);
+  if (kind == TASK_IO)
+    printf (" wakeups=%lld latency=%.3f max=%lld",
+            wakeups, wakeups > 0 ? (double) latency_sum / wakeups : 0.0,
+            latency_max);
+  printf ("\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+  int levels = MFQ_LEVELS_DEFAULT, cpu_tasks = 4, io_tasks = 4;
+  int aging_threshold = MFQ_AGING_THRESHOLD, aging_batch = MFQ_AGING_BATCH;
+  const char *slices = NULL;
+  long long ticks = 1000000, now, idle_ticks = 0;
+  unsigned seed = 1;
+  int verbose = 0, bad_level, opt, i;
+  struct task *cur = NULL;
+  unsigned run_ticks = 0;
+
+  while ((opt = getopt (argc, argv, "l:s:a:b:t:c:i:B:S:r:vh")) != -1)
+    switch (opt)
+      {
+      case 'l': levels = atoi (optarg); break;
+      case 's': slices = optarg; break;
+      case 'a': aging_threshold = atoi (optarg); break;
+      case 'b': aging_batch = atoi (optarg); break;
+      case 't': ticks = atoll (optarg); break;
+      case 'c': cpu_tasks = atoi (optarg); break;
+      case 'i': io_tasks = atoi (optarg); break;
+      case 'B': io_burst = atoi (optarg); break;
+      case 'S': io_sleep = atoi (optarg); break;
+      case 'r': seed = strtoul (optarg, NULL, 0); break;
+      case 'v': verbose = 1; break;
+      default: usage ();
+      }
+
+  if (levels < 1 || levels > RQ_LEVELS_MAX)
+    {
+      fprintf (stderr, "mfqsim: -l must be between 1 and %d\n",
+               RQ_LEVELS_MAX);
+      return EXIT_FAILURE;
+    }
+  if (cpu_tasks < 0 || io_tasks < 0 || cpu_tasks + io_tasks > TASKS_MAX
+      || aging_threshold < 1 || aging_batch < 1 || ticks < 1
+      || io_burst < 1 || io_sleep < 1)
+    {
+      fprintf (stderr, "mfqsim: invalid parameter (use -h for help)\n");
+      return EXIT_FAILURE;
+    }
+  bad_level = mfq_policy_init (&policy, levels, slices);
+  if (bad_level >= 0)
+    {
+      fprintf (stderr, "mfqsim: time slice of level %d must be positive\n",
+               bad_level);
+      return EXIT_FAILURE;
+    }
+  policy.aging_threshold = aging_threshold;
+  policy.aging_batch = aging_batch;
+  srand (seed);
+
+  /* All tasks start at the default priority, as if just created. */
+  rq_init (&rq);
+  for (i = 0; i < cpu_tasks + io_tasks; i++)
+    {
+      struct task *t = &tasks[task_cnt++];
+      t->id = i;
+      t->kind = i < cpu_tasks ? TASK_CPU : TASK_IO;
+      t->base_priority = levels / 2;
+      t->burst_left = io_burst;
+      enqueue (t, 0);
+    }
+
+  for (now = 1; now <= ticks; now++)
+    {
+      /* Wake the sleepers that are due. */
+      for (i = 0; i < task_cnt; i++)
+        if (tasks[i].asleep && tasks[i].wake_tick <= now)
+          wake (&tasks[i], now);
+
+      if (cur == NULL)
+        {
+          cur = pick_next (now);
+          run_ticks = 0;
+          if (cur == NULL)
+            {
+              idle_ticks++;
+              age (now);
+              continue;
+            }
+        }
+
+      /* Charge the tick to the running task. */
+      cur->cpu_ticks++;
+      cur->slice_used++;
+      run_ticks++;
+      age (now);
+
+      if (cur->kind == TASK_IO && --cur->burst_left == 0)
+        {
+          cur->burst_left = io_burst;
+          cur->asleep = 1;
+          cur->wake_tick = now + sleep_length ();
+          cur->vol++;
+          cur = NULL;
+        }
+      else if (run_ticks >= cur->time_slice)
+        {
+          cur->invol++;
+          yield (cur, now);
+          cur = NULL;
+        }
+    }
+
+  printf ("levels=%d aging=%d batch=%d ticks=%lld idle=%.1f%% slices=",
+          levels, policy.aging_threshold, policy.aging_batch, ticks,
+          100.0 * idle_ticks / ticks);
+  for (i = 0; i < levels; i++)
+    printf ("%s%u", i > 0 ? "," : "", policy.slice[i]);
+  printf ("\n");
+  print_kind ("cpu", TASK_CPU, ticks);
+  print_kind ("io", TASK_IO, ticks);
+
+  if (verbose)
+    for (i = 0; i < task_cnt; i++)
+      {
+        struct task *t = &tasks[i];
+        printf ("task %3d %-3s level=%d cpu=%lld vol=%u invol=%u promo=%u "
+                "demo=%u boost=%u wakeups=%lld latency=%.3f\n",
+                t->id, t->kind == TASK_CPU ? "cpu" : "io", t->base_priority,
+                t->cpu_ticks, t->vol, t->invol, t->promotions, t->demotions,
+                t->boosts, t->wakeups,
+                t->wakeups > 0 ? (double) t->latency_sum / t->wakeups : 0.0);
+      }
+  return EXIT_SUCCESS;
+}